@@ -0,0 +1,48 @@
+#include <atomic>
+#include <stddef.h>
+#include "allocator.h"
+#include "polypool.h"
+
+static void *Allocator_PoolAlloc(void *, int numbytes)
+{
+	return PolyPool_MemAlloc(numbytes);
+}
+
+static void Allocator_PoolFree(void *, void *p)
+{
+	PolyPool_MemFree(p);
+}
+
+static allocator_t			allocator_default = { Allocator_PoolAlloc, Allocator_PoolFree, NULL };
+static std::atomic<allocator_t*>	allocator_global(&allocator_default);
+static thread_local allocator_t		*allocator_thread = NULL;
+
+allocator_t *Allocator_Default()
+{
+	return &allocator_default;
+}
+
+void Allocator_SetGlobal(allocator_t *a)
+{
+	allocator_global.store(a ? a : &allocator_default, std::memory_order_release);
+}
+
+void Allocator_SetThread(allocator_t *a)
+{
+	allocator_thread = a;
+}
+
+allocator_t *Allocator_Thread()
+{
+	return allocator_thread;
+}
+
+allocator_t *Allocator_Current()
+{
+	if(allocator_thread)
+	{
+		return allocator_thread;
+	}
+
+	return allocator_global.load(std::memory_order_acquire);
+}
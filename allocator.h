@@ -0,0 +1,51 @@
+/*=============================================================================
+	allocator.h
+============================================================================*/
+
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+/*-----------------------------------------------------------------------------
+	allocator_t
+
+	allocation callbacks with a context pointer, used by polygon_t and
+	volume_t. objects remember the allocator they came from and go back to
+	it when freed, so an allocator must accept frees from other threads if
+	its objects are passed between them.
+
+	new objects come from the allocator bound to the calling thread, then
+	the global one, which starts out as the default and is also replaced by
+	Polygon_SetMemCallbacks. the default is the polygon pool with thread
+	caches and never takes a lock
+-----------------------------------------------------------------------------*/
+
+typedef struct allocator_s
+{
+	void	*(*alloc)(void *context, int numbytes);
+	void	(*free)(void *context, void *p);
+	void	*context;
+
+} allocator_t;
+
+allocator_t *Allocator_Default();
+
+// NULL restores the default, the allocator must outlive its objects
+void Allocator_SetGlobal(allocator_t *a);
+// NULL unbinds the calling thread
+void Allocator_SetThread(allocator_t *a);
+
+// the calling thread's allocator or NULL
+allocator_t *Allocator_Thread();
+allocator_t *Allocator_Current();
+
+inline void *Allocator_Alloc(allocator_t *a, int numbytes)
+{
+	return a->alloc(a->context, numbytes);
+}
+
+inline void Allocator_Free(allocator_t *a, void *p)
+{
+	a->free(a->context, p);
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include <assert.h>
+#include <stdlib.h>
+#include "arena.h"
+
+// block headers are padded so the data after them stays aligned
+#define ARENA_HEADERSIZE	((sizeof(arena_block_t) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+static arena_t			*arena_shared = NULL;
+static thread_local arena_t	*arena_thread = NULL;
+
+static void *Arena_AllocatorAlloc(void *context, int numbytes)
+{
+	return Arena_Push((arena_t*)context, numbytes);
+}
+
+static void Arena_AllocatorFree(void *, void *)
+{
+}
+
+static arena_block_t *Arena_AllocBlock(int size)
+{
+	arena_block_t *b = (arena_block_t*)malloc(ARENA_HEADERSIZE + size);
+	if(!b)
+		return NULL;
+
+	b->next	= NULL;
+	b->size	= size;
+	b->used	= 0;
+
+	return b;
+}
+
+static void *Arena_BlockData(arena_block_t *b)
+{
+	return (char*)b + ARENA_HEADERSIZE;
+}
+
+/*-----------------------------------------------------------------------------
+	arena_t
+-----------------------------------------------------------------------------*/
+
+arena_t *Arena_Alloc(int blocksize)
+{
+	arena_t *a = (arena_t*)malloc(sizeof(arena_t));
+	if(!a)
+		return NULL;
+
+	a->blocksize	= (blocksize + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	a->first	= Arena_AllocBlock(a->blocksize);
+	a->current	= a->first;
+
+	if(!a->first)
+	{
+		free(a);
+		return NULL;
+	}
+
+	return a;
+}
+
+void Arena_Free(arena_t *a)
+{
+	arena_block_t *next;
+
+	for(arena_block_t *b = a->first; b; b = next)
+	{
+		next = b->next;
+		free(b);
+	}
+
+	free(a);
+}
+
+// the blocks after current are left over from before a Release or Reset
+// and are reused in order. one too small for the request is skipped over
+// by a new block linked in ahead of it
+void *Arena_Push(arena_t *a, int numbytes)
+{
+	arena_block_t *b = a->current;
+
+	numbytes = (numbytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+	if(b->used + numbytes > b->size)
+	{
+		arena_block_t *next = b->next;
+
+		if(next && next->size >= numbytes)
+		{
+			b = next;
+		}
+		else
+		{
+			// out of memory leaves the arena as it was
+			b = Arena_AllocBlock((numbytes > a->blocksize) ? numbytes : a->blocksize);
+			if(!b)
+				return NULL;
+
+			b->next = next;
+			a->current->next = b;
+		}
+
+		b->used = 0;
+		a->current = b;
+	}
+
+	void *p = (char*)Arena_BlockData(b) + b->used;
+	b->used += numbytes;
+
+	return p;
+}
+
+arena_mark_t Arena_Mark(arena_t *a)
+{
+	arena_mark_t mark;
+
+	mark.block	= a->current;
+	mark.used	= a->current->used;
+
+	return mark;
+}
+
+void Arena_Release(arena_t *a, arena_mark_t mark)
+{
+	a->current	= mark.block;
+	a->current->used = mark.used;
+}
+
+void Arena_Reset(arena_t *a)
+{
+	a->current	= a->first;
+	a->current->used = 0;
+}
+
+/*-----------------------------------------------------------------------------
+	memory callbacks
+-----------------------------------------------------------------------------*/
+
+void Arena_SetShared(arena_t *a)
+{
+	arena_shared = a;
+}
+
+void Arena_SetThread(arena_t *a)
+{
+	arena_thread = a;
+}
+
+arena_t *Arena_Current()
+{
+	return arena_thread ? arena_thread : arena_shared;
+}
+
+void *Arena_MemAlloc(int numbytes)
+{
+	arena_t *a = Arena_Current();
+
+	assert(a != NULL);
+
+	return Arena_Push(a, numbytes);
+}
+
+void Arena_MemFree(void *)
+{
+}
+
+void Arena_InitAllocator(allocator_t *out, arena_t *a)
+{
+	out->alloc	= Arena_AllocatorAlloc;
+	out->free	= Arena_AllocatorFree;
+	out->context	= a;
+}
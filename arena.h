@@ -0,0 +1,90 @@
+/*=============================================================================
+	arena.h
+============================================================================*/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include "allocator.h"
+
+// every allocation is rounded up to this, enough for vec3 and pointers
+#define ARENA_ALIGN		16
+#define ARENA_DEFAULT_BLOCKSIZE	(256 * 1024)
+
+/*-----------------------------------------------------------------------------
+	arena_t
+
+	bump allocator over a chain of blocks. Arena_Push moves a pointer,
+	Arena_Release rewinds to a mark and Arena_Reset rewinds to the start,
+	both in constant time. blocks are kept for reuse until Arena_Free.
+	requests larger than the block size get a block of their own.
+	Arena_Alloc and Arena_Push return NULL when malloc fails.
+
+	an arena is not thread safe, give each thread its own
+-----------------------------------------------------------------------------*/
+
+typedef struct arena_block_s
+{
+	struct arena_block_s	*next;
+	int			size;
+	int			used;
+
+} arena_block_t;
+
+typedef struct arena_s
+{
+	int		blocksize;
+	arena_block_t	*first;
+	arena_block_t	*current;
+
+} arena_t;
+
+typedef struct arena_mark_s
+{
+	arena_block_t	*block;
+	int		used;
+
+} arena_mark_t;
+
+arena_t *Arena_Alloc(int blocksize = ARENA_DEFAULT_BLOCKSIZE);
+void Arena_Free(arena_t *a);
+void *Arena_Push(arena_t *a, int numbytes);
+arena_mark_t Arena_Mark(arena_t *a);
+void Arena_Release(arena_t *a, arena_mark_t mark);
+void Arena_Reset(arena_t *a);
+
+// releases everything pushed during its lifetime
+class arena_scope_t
+{
+public:
+	arena_scope_t(arena_t *a) : arena(a), mark(Arena_Mark(a)) {}
+	~arena_scope_t() { Arena_Release(arena, mark); }
+
+private:
+	arena_t		*arena;
+	arena_mark_t	mark;
+
+	arena_scope_t(const arena_scope_t&);
+	arena_scope_t& operator=(const arena_scope_t&);
+};
+
+/*-----------------------------------------------------------------------------
+	memory callbacks
+
+	Arena_MemAlloc and Arena_MemFree fit Polygon_SetMemCallbacks. allocations
+	come from the calling thread's arena if it has one, otherwise from the
+	shared arena, which must then only be used by one thread at a time.
+	Arena_MemFree does nothing, the memory goes back on Release or Reset
+-----------------------------------------------------------------------------*/
+
+void Arena_SetShared(arena_t *a);
+void Arena_SetThread(arena_t *a);
+arena_t *Arena_Current();
+
+void *Arena_MemAlloc(int numbytes);
+void Arena_MemFree(void *p);
+
+// an allocator_t pushing on a, for Allocator_SetThread or Polygon_AllocWith
+void Arena_InitAllocator(allocator_t *out, arena_t *a);
+
+#endif
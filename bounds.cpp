@@ -0,0 +1,131 @@
+#include <assert.h>
+#include "bounds.h"
+#include "parallel.h"
+
+#define BOUNDS_HUGE	(1e20f)
+
+// polygons with more vertices than this are reduced on their own instead of
+// holding up a whole lane group
+#define BOUNDS_LANEVERTICES	32
+
+#define SIMD_KERNELS "bounds_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(Bounds_PointsKernel);
+SIMD_DISPATCH(Bounds_SoAKernel);
+SIMD_DISPATCH(Bounds_PolygonsKernel);
+
+// polygons per worker chunk
+#define BOUNDS_POLYGON_GRAIN	1024
+
+/*-----------------------------------------------------------------------------
+	bounds_soa
+-----------------------------------------------------------------------------*/
+
+bounds_soa *Bounds_Alloc(int maxboxes)
+{
+	bounds_soa	*b;
+
+	// header in the first alignment block, then the six component arrays
+	int capacity = (maxboxes + VEC3SOA_GRANULARITY - 1) & ~(VEC3SOA_GRANULARITY - 1);
+	int numbytes = SIMD_ALIGN + (6 * capacity * sizeof(float));
+	b = (bounds_soa*)Simd_AlignedAlloc(numbytes);
+	if(!b)
+		return NULL;
+
+	float *base = (float*)((char*)b + SIMD_ALIGN);
+
+	b->maxboxes	= maxboxes;
+	b->numboxes	= 0;
+	b->minx		= base;
+	b->miny		= base + capacity;
+	b->minz		= base + (2 * capacity);
+	b->maxx		= base + (3 * capacity);
+	b->maxy		= base + (4 * capacity);
+	b->maxz		= base + (5 * capacity);
+
+	return b;
+}
+
+void Bounds_Free(bounds_soa *b)
+{
+	Simd_AlignedFree(b);
+}
+
+void Bounds_Set(bounds_soa *b, int i, const vec3& bmin, const vec3& bmax)
+{
+	b->minx[i] = bmin.x;
+	b->miny[i] = bmin.y;
+	b->minz[i] = bmin.z;
+	b->maxx[i] = bmax.x;
+	b->maxy[i] = bmax.y;
+	b->maxz[i] = bmax.z;
+}
+
+void Bounds_Get(const bounds_soa *b, int i, vec3 *bmin, vec3 *bmax)
+{
+	*bmin = vec3(b->minx[i], b->miny[i], b->minz[i]);
+	*bmax = vec3(b->maxx[i], b->maxy[i], b->maxz[i]);
+}
+
+/*-----------------------------------------------------------------------------
+	reductions
+-----------------------------------------------------------------------------*/
+
+void Bounds_FromPoints(const vec3 *points, int numpoints, vec3 *bmin, vec3 *bmax)
+{
+	*bmin = vec3( BOUNDS_HUGE,  BOUNDS_HUGE,  BOUNDS_HUGE);
+	*bmax = vec3(-BOUNDS_HUGE, -BOUNDS_HUGE, -BOUNDS_HUGE);
+
+	int i = SIMD_CALL(Bounds_PointsKernel)(points, bmin, bmax, 0, numpoints);
+	Bounds_PointsKernel_scalar(points, bmin, bmax, i, numpoints);
+}
+
+void Bounds_FromSoA(const vec3_soa *points, vec3 *bmin, vec3 *bmax)
+{
+	*bmin = vec3( BOUNDS_HUGE,  BOUNDS_HUGE,  BOUNDS_HUGE);
+	*bmax = vec3(-BOUNDS_HUGE, -BOUNDS_HUGE, -BOUNDS_HUGE);
+
+	int i = SIMD_CALL(Bounds_SoAKernel)(points, bmin, bmax, 0, points->numvectors);
+	Bounds_SoAKernel_scalar(points, bmin, bmax, i, points->numvectors);
+}
+
+typedef struct bounds_polygonjob_s
+{
+	bounds_soa	*out;
+	polygon_t	**polygons;
+} bounds_polygonjob_t;
+
+static void Bounds_PolygonChunk(void *context, int start, int end)
+{
+	bounds_polygonjob_t *job = (bounds_polygonjob_t*)context;
+
+	int i = SIMD_CALL(Bounds_PolygonsKernel)(job->out, job->polygons, start, end);
+	Bounds_PolygonsKernel_scalar(job->out, job->polygons, i, end);
+
+	// the lanes the kernel skipped
+	for(i = start; i < end; i++)
+	{
+		polygon_t	*p = job->polygons[i];
+		vec3		bmin, bmax;
+
+		if(p->numvertices >= 1 && p->numvertices <= BOUNDS_LANEVERTICES)
+			continue;
+
+		Bounds_FromPoints(p->vertices, p->numvertices, &bmin, &bmax);
+		Bounds_Set(job->out, i, bmin, bmax);
+	}
+}
+
+void Bounds_FromPolygons(bounds_soa *out, polygon_t **polygons, int numpolygons)
+{
+	bounds_polygonjob_t	job;
+
+	assert(numpolygons <= out->maxboxes);
+
+	job.out		= out;
+	job.polygons	= polygons;
+
+	Parallel_For(numpolygons, BOUNDS_POLYGON_GRAIN, Bounds_PolygonChunk, &job);
+	out->numboxes = numpolygons;
+}
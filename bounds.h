@@ -0,0 +1,45 @@
+/*=============================================================================
+	bounds.h
+============================================================================*/
+
+#ifndef __BOUNDS_H__
+#define __BOUNDS_H__
+
+#include "vector.h"
+#include "vec3soa.h"
+#include "polygon.h"
+
+/*-----------------------------------------------------------------------------
+	bounds_soa
+
+	axis aligned boxes with each min and max component in its own aligned
+	array
+-----------------------------------------------------------------------------*/
+
+typedef struct bounds_soa_s
+{
+	int	maxboxes;
+	int	numboxes;
+	float	*minx;
+	float	*miny;
+	float	*minz;
+	float	*maxx;
+	float	*maxy;
+	float	*maxz;
+
+} bounds_soa;
+
+bounds_soa *Bounds_Alloc(int maxboxes);
+void Bounds_Free(bounds_soa *b);
+void Bounds_Set(bounds_soa *b, int i, const vec3& bmin, const vec3& bmax);
+void Bounds_Get(const bounds_soa *b, int i, vec3 *bmin, vec3 *bmax);
+
+// min and max of a point array. an empty array gives the inverted 1e20 box
+void Bounds_FromPoints(const vec3 *points, int numpoints, vec3 *bmin, vec3 *bmax);
+void Bounds_FromSoA(const vec3_soa *points, vec3 *bmin, vec3 *bmax);
+
+// one box per polygon, written to out->minx[i] .. out->maxz[i]. large
+// polygon sets are split across the worker threads
+void Bounds_FromPolygons(bounds_soa *out, polygon_t **polygons, int numpolygons);
+
+#endif
@@ -0,0 +1,174 @@
+/*=============================================================================
+	bounds_kernels.inl
+
+	per-tier min/max reductions, see simd_variants.h. the kernels fold into
+	the bmin and bmax they are given so the scalar tail can continue them
+-----------------------------------------------------------------------------*/
+
+// a vec3 array is read as flat floats, SIMD_WIDTH vertices per three
+// registers. the stride keeps every lane on the same component, so lane k
+// of register r holds component (r * SIMD_WIDTH + k) % 3
+static int SIMD_FN(Bounds_PointsKernel)(const vec3 *points, vec3 *bmin, vec3 *bmax, int start, int end)
+{
+	int i;
+	const float *f = (const float*)points;
+
+	vfloat mn0 = VF_SET1(BOUNDS_HUGE), mn1 = mn0, mn2 = mn0;
+	vfloat mx0 = VF_SET1(-BOUNDS_HUGE), mx1 = mx0, mx2 = mx0;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		const float *p = f + (3 * i);
+
+		vfloat a = VF_LOADU(p);
+		vfloat b = VF_LOADU(p + SIMD_WIDTH);
+		vfloat c = VF_LOADU(p + (2 * SIMD_WIDTH));
+
+		mn0 = VF_MIN(mn0, a); mx0 = VF_MAX(mx0, a);
+		mn1 = VF_MIN(mn1, b); mx1 = VF_MAX(mx1, b);
+		mn2 = VF_MIN(mn2, c); mx2 = VF_MAX(mx2, c);
+	}
+
+	float mins[3 * SIMD_WIDTH];
+	float maxs[3 * SIMD_WIDTH];
+
+	VF_STOREU(mins, mn0);
+	VF_STOREU(mins + SIMD_WIDTH, mn1);
+	VF_STOREU(mins + (2 * SIMD_WIDTH), mn2);
+	VF_STOREU(maxs, mx0);
+	VF_STOREU(maxs + SIMD_WIDTH, mx1);
+	VF_STOREU(maxs + (2 * SIMD_WIDTH), mx2);
+
+	for(int k = 0; k < 3 * SIMD_WIDTH; k++)
+	{
+		float &lo = (*bmin)[k % 3];
+		float &hi = (*bmax)[k % 3];
+
+		lo = (mins[k] < lo) ? mins[k] : lo;
+		hi = (maxs[k] > hi) ? maxs[k] : hi;
+	}
+
+	return i;
+}
+
+static float SIMD_FN(Bounds_ReduceMin)(vfloat v)
+{
+	float lanes[SIMD_WIDTH];
+	float r;
+
+	VF_STOREU(lanes, v);
+
+	r = lanes[0];
+	for(int k = 1; k < SIMD_WIDTH; k++)
+		r = (lanes[k] < r) ? lanes[k] : r;
+
+	return r;
+}
+
+static float SIMD_FN(Bounds_ReduceMax)(vfloat v)
+{
+	float lanes[SIMD_WIDTH];
+	float r;
+
+	VF_STOREU(lanes, v);
+
+	r = lanes[0];
+	for(int k = 1; k < SIMD_WIDTH; k++)
+		r = (lanes[k] > r) ? lanes[k] : r;
+
+	return r;
+}
+
+static int SIMD_FN(Bounds_SoAKernel)(const vec3_soa *points, vec3 *bmin, vec3 *bmax, int start, int end)
+{
+	const float *planes[3] = { points->x, points->y, points->z };
+	int i = start;
+
+	for(int j = 0; j < 3; j++)
+	{
+		vfloat mn = VF_SET1((*bmin)[j]);
+		vfloat mx = VF_SET1((*bmax)[j]);
+
+		for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+		{
+			vfloat a = VF_LOAD(planes[j] + i);
+
+			mn = VF_MIN(mn, a);
+			mx = VF_MAX(mx, a);
+		}
+
+		(*bmin)[j] = SIMD_FN(Bounds_ReduceMin)(mn);
+		(*bmax)[j] = SIMD_FN(Bounds_ReduceMax)(mx);
+	}
+
+	return i;
+}
+
+// one polygon per lane. each step gathers vertex k of SIMD_WIDTH polygons
+// into lane arrays, a polygon shorter than the longest in the group repeats
+// its last vertex. empty polygons and ones over BOUNDS_LANEVERTICES are left
+// for Bounds_PolygonChunk to fix up
+static int SIMD_FN(Bounds_PolygonsKernel)(bounds_soa *out, polygon_t **polygons, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		const vec3	*v[SIMD_WIDTH];
+		int		last[SIMD_WIDTH];
+		int		count = 0;
+
+		for(int k = 0; k < SIMD_WIDTH; k++)
+		{
+			const polygon_t *p = polygons[i + k];
+			int n = p->numvertices;
+
+			if(n < 1 || n > BOUNDS_LANEVERTICES)
+			{
+				v[k]	= &vec3_zero;
+				last[k]	= 0;
+				continue;
+			}
+
+			v[k]	= p->vertices;
+			last[k]	= n - 1;
+			count	= (n > count) ? n : count;
+		}
+
+		vfloat mnx = VF_SET1(BOUNDS_HUGE), mny = mnx, mnz = mnx;
+		vfloat mxx = VF_SET1(-BOUNDS_HUGE), mxy = mxx, mxz = mxx;
+
+		for(int j = 0; j < count; j++)
+		{
+			float x[SIMD_WIDTH];
+			float y[SIMD_WIDTH];
+			float z[SIMD_WIDTH];
+
+			for(int k = 0; k < SIMD_WIDTH; k++)
+			{
+				const vec3 &a = v[k][(j < last[k]) ? j : last[k]];
+
+				x[k] = a.x;
+				y[k] = a.y;
+				z[k] = a.z;
+			}
+
+			vfloat vx = VF_LOADU(x);
+			vfloat vy = VF_LOADU(y);
+			vfloat vz = VF_LOADU(z);
+
+			mnx = VF_MIN(mnx, vx); mxx = VF_MAX(mxx, vx);
+			mny = VF_MIN(mny, vy); mxy = VF_MAX(mxy, vy);
+			mnz = VF_MIN(mnz, vz); mxz = VF_MAX(mxz, vz);
+		}
+
+		VF_STOREU(out->minx + i, mnx);
+		VF_STOREU(out->miny + i, mny);
+		VF_STOREU(out->minz + i, mnz);
+		VF_STOREU(out->maxx + i, mxx);
+		VF_STOREU(out->maxy + i, mxy);
+		VF_STOREU(out->maxz + i, mxz);
+	}
+
+	return i;
+}
@@ -0,0 +1,176 @@
+#include <atomic>
+#include <string.h>
+#include "frustum.h"
+#include "parallel.h"
+
+static inline int Frustum_CountBits(unsigned int bits)
+{
+	int count = 0;
+
+	for(; bits; bits &= bits - 1)
+		count++;
+
+	return count;
+}
+
+#define SIMD_KERNELS "frustum_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(Frustum_BoundsKernel);
+SIMD_DISPATCH(Frustum_SpheresKernel);
+
+// objects per worker chunk, a multiple of 32 so that chunks never share a
+// word of the visibility mask
+#define FRUSTUM_GRAIN		2048
+
+/*-----------------------------------------------------------------------------
+	extraction
+-----------------------------------------------------------------------------*/
+
+void Frustum_FromMatrix(frustum_t *f, const mat4x4& viewproj)
+{
+	vec4 x = viewproj.m[0];
+	vec4 y = viewproj.m[1];
+	vec4 z = viewproj.m[2];
+	vec4 w = viewproj.m[3];
+
+	// -w <= x <= w and so on for the clip space coordinates of a point
+	vec4 p[FRUSTUM_NUMPLANES];
+
+	p[FRUSTUM_LEFT]		= w + x;
+	p[FRUSTUM_RIGHT]	= w - x;
+	p[FRUSTUM_BOTTOM]	= w + y;
+	p[FRUSTUM_TOP]		= w - y;
+	p[FRUSTUM_NEAR]		= w + z;
+	p[FRUSTUM_FAR]		= w - z;
+
+	for(int i = 0; i < FRUSTUM_NUMPLANES; i++)
+	{
+		f->planes[i] = plane_t(p[i].x, p[i].y, p[i].z, p[i].w);
+		f->planes[i].Normalize();
+
+		f->order[i]	= i;
+		f->culled[i]	= 0;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	culling
+-----------------------------------------------------------------------------*/
+
+typedef struct frustum_job_s
+{
+	const frustum_t		*f;
+	unsigned int		*visible;
+	unsigned char		*hints;
+
+	const bounds_soa	*boxes;
+	const vec3_soa		*centers;
+	const float		*radii;
+
+	std::atomic<int>	culled[FRUSTUM_NUMPLANES];
+
+} frustum_job_t;
+
+static void Frustum_AddCulled(frustum_job_t *job, const int *culled)
+{
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+	{
+		if(culled[k])
+			job->culled[k] += culled[k];
+	}
+}
+
+static void Frustum_BoundsChunk(void *context, int start, int end)
+{
+	frustum_job_t	*job = (frustum_job_t*)context;
+	int		culled[FRUSTUM_NUMPLANES] = { 0 };
+
+	int i = SIMD_CALL(Frustum_BoundsKernel)(job->f, job->boxes, job->visible, job->hints, culled, start, end);
+	Frustum_BoundsKernel_scalar(job->f, job->boxes, job->visible, job->hints, culled, i, end);
+
+	Frustum_AddCulled(job, culled);
+}
+
+static void Frustum_SpheresChunk(void *context, int start, int end)
+{
+	frustum_job_t	*job = (frustum_job_t*)context;
+	int		culled[FRUSTUM_NUMPLANES] = { 0 };
+
+	int i = SIMD_CALL(Frustum_SpheresKernel)(job->f, job->centers, job->radii, job->visible, job->hints, culled, start, end);
+	Frustum_SpheresKernel_scalar(job->f, job->centers, job->radii, job->visible, job->hints, culled, i, end);
+
+	Frustum_AddCulled(job, culled);
+}
+
+static void Frustum_BeginJob(frustum_job_t *job, const frustum_t *f, unsigned int *visible, unsigned char *hints, int count)
+{
+	job->f		= f;
+	job->visible	= visible;
+	job->hints	= hints;
+
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+		job->culled[k] = 0;
+
+	memset(visible, 0, FRUSTUM_MASKWORDS(count) * sizeof(unsigned int));
+}
+
+// record the rejection counts and move the busiest planes to the front
+static int Frustum_EndJob(frustum_job_t *job, frustum_t *f, const unsigned int *visible, int count)
+{
+	int	numvisible = 0;
+	int	culled[FRUSTUM_NUMPLANES];
+
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+		culled[k] = job->culled[k];
+
+	// insertion sort of the plane order, stable for equal counts
+	for(int k = 1; k < FRUSTUM_NUMPLANES; k++)
+	{
+		int plane = f->order[k];
+		int n = culled[k];
+		int j;
+
+		for(j = k; j > 0 && culled[j - 1] < n; j--)
+		{
+			f->order[j] = f->order[j - 1];
+			culled[j] = culled[j - 1];
+		}
+
+		f->order[j] = plane;
+		culled[j] = n;
+	}
+
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+		f->culled[f->order[k]] = culled[k];
+
+	for(int i = 0; i < FRUSTUM_MASKWORDS(count); i++)
+		numvisible += Frustum_CountBits(visible[i]);
+
+	return numvisible;
+}
+
+int Frustum_CullBounds(frustum_t *f, const bounds_soa *boxes, unsigned int *visible, unsigned char *hints)
+{
+	frustum_job_t job;
+
+	Frustum_BeginJob(&job, f, visible, hints, boxes->numboxes);
+	job.boxes = boxes;
+
+	Parallel_For(boxes->numboxes, FRUSTUM_GRAIN, Frustum_BoundsChunk, &job);
+
+	return Frustum_EndJob(&job, f, visible, boxes->numboxes);
+}
+
+int Frustum_CullSpheres(frustum_t *f, const vec3_soa *centers, const float *radii, unsigned int *visible, unsigned char *hints)
+{
+	frustum_job_t job;
+
+	Frustum_BeginJob(&job, f, visible, hints, centers->numvectors);
+	job.centers	= centers;
+	job.radii	= radii;
+
+	Parallel_For(centers->numvectors, FRUSTUM_GRAIN, Frustum_SpheresChunk, &job);
+
+	return Frustum_EndJob(&job, f, visible, centers->numvectors);
+}
@@ -0,0 +1,63 @@
+/*=============================================================================
+	frustum.h
+============================================================================*/
+
+#ifndef __FRUSTUM_H__
+#define __FRUSTUM_H__
+
+#include "vector.h"
+#include "matrix.h"
+#include "plane.h"
+#include "vec3soa.h"
+#include "bounds.h"
+
+#define FRUSTUM_LEFT		0
+#define FRUSTUM_RIGHT		1
+#define FRUSTUM_BOTTOM		2
+#define FRUSTUM_TOP		3
+#define FRUSTUM_NEAR		4
+#define FRUSTUM_FAR		5
+#define FRUSTUM_NUMPLANES	6
+
+// words needed for a per-object visibility bitmask
+#define FRUSTUM_MASKWORDS(n)	(((n) + 31) >> 5)
+
+// per-object hint for an object that was not rejected by any plane
+#define FRUSTUM_NOHINT		0xff
+
+/*-----------------------------------------------------------------------------
+	frustum_t
+
+	six unit length planes facing into the volume, so a point is inside
+	when every Distance is positive. the planes are tested in order[], which
+	each cull call re-sorts so the plane that rejected the most objects is
+	tried first on the next frame.
+
+	callers that keep the objects between frames can also pass one hint
+	byte per object. it holds the plane that last rejected the object and
+	that plane is tested before order[], an object that stays just outside
+	one plane is then rejected by its first test
+-----------------------------------------------------------------------------*/
+
+typedef struct frustum_s
+{
+	plane_t	planes[FRUSTUM_NUMPLANES];
+
+	int	order[FRUSTUM_NUMPLANES];
+	int	culled[FRUSTUM_NUMPLANES];	// rejections per plane in the last call
+
+} frustum_t;
+
+// extract the planes of a column vector view-projection matrix with clip
+// space depth from -w to w
+void Frustum_FromMatrix(frustum_t *f, const mat4x4& viewproj);
+
+// bit i of visible is set when box or sphere i is inside or crosses the
+// frustum. visible must hold FRUSTUM_MASKWORDS(n) words. hints is NULL or
+// one byte per object, start them at FRUSTUM_NOHINT. a stale hint only
+// costs a plane test. large sets are split across the worker threads.
+// returns the number of visible objects
+int Frustum_CullBounds(frustum_t *f, const bounds_soa *boxes, unsigned int *visible, unsigned char *hints = NULL);
+int Frustum_CullSpheres(frustum_t *f, const vec3_soa *centers, const float *radii, unsigned int *visible, unsigned char *hints = NULL);
+
+#endif
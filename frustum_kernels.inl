@@ -0,0 +1,187 @@
+/*=============================================================================
+	frustum_kernels.inl
+
+	per-tier culling, see simd_variants.h. each packet of SIMD_WIDTH objects
+	is first tested against the plane that rejected each object last time,
+	when hints are given, then against the planes in f->order, stopping as
+	soon as every lane has been rejected. rejections are credited to the
+	order slot of the plane that made them in culled[]
+-----------------------------------------------------------------------------*/
+
+// gather the hinted plane of each lane. lanes without a hint get a plane
+// that every point is in front of. returns the lanes that have a hint
+static unsigned int SIMD_FN(Frustum_GatherHints)(const frustum_t *f, const unsigned char *hints, vfloat *a, vfloat *b, vfloat *c, vfloat *d)
+{
+	float		pa[SIMD_WIDTH], pb[SIMD_WIDTH], pc[SIMD_WIDTH], pd[SIMD_WIDTH];
+	unsigned int	hinted = 0;
+
+	for(int k = 0; k < SIMD_WIDTH; k++)
+	{
+		if(hints[k] >= FRUSTUM_NUMPLANES)
+		{
+			pa[k] = pb[k] = pc[k] = 0.0f;
+			pd[k] = 1.0f;
+			continue;
+		}
+
+		const plane_t *p = &f->planes[hints[k]];
+
+		pa[k] = p->a;
+		pb[k] = p->b;
+		pc[k] = p->c;
+		pd[k] = p->d;
+		hinted |= 1u << k;
+	}
+
+	if(hinted)
+	{
+		*a = VF_LOADU(pa);
+		*b = VF_LOADU(pb);
+		*c = VF_LOADU(pc);
+		*d = VF_LOADU(pd);
+	}
+
+	return hinted;
+}
+
+// credit the hint rejections and remember the plane that rejected each lane
+// in the ordered pass. visible lanes lose their hint
+static void SIMD_FN(Frustum_UpdateHints)(const int *slot, unsigned char *hints, const unsigned char *rejectedby, unsigned int hintout, unsigned int alive, int *culled)
+{
+	for(int k = 0; k < SIMD_WIDTH; k++)
+	{
+		if(hintout & (1u << k))
+			culled[slot[hints[k]]]++;
+		else if(alive & (1u << k))
+			hints[k] = FRUSTUM_NOHINT;
+		else
+			hints[k] = rejectedby[k];
+	}
+}
+
+// for a box the only corner that matters is the one furthest along the
+// plane normal. the sign of each normal component picks the min or max
+// array for every lane at once, so there is no per-lane select
+static int SIMD_FN(Frustum_BoundsKernel)(const frustum_t *f, const bounds_soa *b, unsigned int *visible, unsigned char *hints, int *culled, int start, int end)
+{
+	int		i;
+	int		slot[FRUSTUM_NUMPLANES];
+	unsigned char	rejectedby[SIMD_WIDTH];
+
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+		slot[f->order[k]] = k;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		unsigned int alive = (1u << SIMD_WIDTH) - 1;
+		unsigned int hintout = 0;
+
+		// each lane has its own plane here, so the corner is picked per lane
+		vfloat ha, hb, hc, hd;
+		if(hints && SIMD_FN(Frustum_GatherHints)(f, hints + i, &ha, &hb, &hc, &hd))
+		{
+			vfloat x = VF_SELECT(VF_CMPGE(ha, VF_ZERO()), VF_LOADU(b->maxx + i), VF_LOADU(b->minx + i));
+			vfloat y = VF_SELECT(VF_CMPGE(hb, VF_ZERO()), VF_LOADU(b->maxy + i), VF_LOADU(b->miny + i));
+			vfloat z = VF_SELECT(VF_CMPGE(hc, VF_ZERO()), VF_LOADU(b->maxz + i), VF_LOADU(b->minz + i));
+
+			vfloat d = VF_FMADD(ha, x, hd);
+			d = VF_FMADD(hb, y, d);
+			d = VF_FMADD(hc, z, d);
+
+			hintout = (unsigned int)VM_BITS(VF_CMPLT(d, VF_ZERO())) & alive;
+			alive &= ~hintout;
+		}
+
+		for(int k = 0; k < FRUSTUM_NUMPLANES && alive; k++)
+		{
+			const plane_t *p = &f->planes[f->order[k]];
+
+			const float *px = (p->a >= 0.0f) ? b->maxx : b->minx;
+			const float *py = (p->b >= 0.0f) ? b->maxy : b->miny;
+			const float *pz = (p->c >= 0.0f) ? b->maxz : b->minz;
+
+			vfloat d = VF_FMADD(VF_SET1(p->a), VF_LOADU(px + i), VF_SET1(p->d));
+			d = VF_FMADD(VF_SET1(p->b), VF_LOADU(py + i), d);
+			d = VF_FMADD(VF_SET1(p->c), VF_LOADU(pz + i), d);
+
+			unsigned int out = (unsigned int)VM_BITS(VF_CMPLT(d, VF_ZERO())) & alive;
+
+			for(int l = 0; hints && out && l < SIMD_WIDTH; l++)
+			{
+				if(out & (1u << l))
+					rejectedby[l] = (unsigned char)f->order[k];
+			}
+
+			culled[k] += Frustum_CountBits(out);
+			alive &= ~out;
+		}
+
+		if(hints)
+			SIMD_FN(Frustum_UpdateHints)(slot, hints + i, rejectedby, hintout, alive, culled);
+
+		// callers keep start a multiple of 32, so a packet never straddles
+		// two mask words
+		visible[i >> 5] |= alive << (i & 31);
+	}
+
+	return i;
+}
+
+static int SIMD_FN(Frustum_SpheresKernel)(const frustum_t *f, const vec3_soa *centers, const float *radii, unsigned int *visible, unsigned char *hints, int *culled, int start, int end)
+{
+	int		i;
+	int		slot[FRUSTUM_NUMPLANES];
+	unsigned char	rejectedby[SIMD_WIDTH];
+
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+		slot[f->order[k]] = k;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		unsigned int alive = (1u << SIMD_WIDTH) - 1;
+		unsigned int hintout = 0;
+
+		vfloat x = VF_LOADU(centers->x + i);
+		vfloat y = VF_LOADU(centers->y + i);
+		vfloat z = VF_LOADU(centers->z + i);
+		vfloat r = VF_SUB(VF_ZERO(), VF_LOADU(radii + i));
+
+		vfloat ha, hb, hc, hd;
+		if(hints && SIMD_FN(Frustum_GatherHints)(f, hints + i, &ha, &hb, &hc, &hd))
+		{
+			vfloat d = VF_FMADD(ha, x, hd);
+			d = VF_FMADD(hb, y, d);
+			d = VF_FMADD(hc, z, d);
+
+			hintout = (unsigned int)VM_BITS(VF_CMPLT(d, r)) & alive;
+			alive &= ~hintout;
+		}
+
+		for(int k = 0; k < FRUSTUM_NUMPLANES && alive; k++)
+		{
+			const plane_t *p = &f->planes[f->order[k]];
+
+			vfloat d = VF_FMADD(VF_SET1(p->a), x, VF_SET1(p->d));
+			d = VF_FMADD(VF_SET1(p->b), y, d);
+			d = VF_FMADD(VF_SET1(p->c), z, d);
+
+			unsigned int out = (unsigned int)VM_BITS(VF_CMPLT(d, r)) & alive;
+
+			for(int l = 0; hints && out && l < SIMD_WIDTH; l++)
+			{
+				if(out & (1u << l))
+					rejectedby[l] = (unsigned char)f->order[k];
+			}
+
+			culled[k] += Frustum_CountBits(out);
+			alive &= ~out;
+		}
+
+		if(hints)
+			SIMD_FN(Frustum_UpdateHints)(slot, hints + i, rejectedby, hintout, alive, culled);
+
+		visible[i >> 5] |= alive << (i & 31);
+	}
+
+	return i;
+}
@@ -0,0 +1,234 @@
+#include <assert.h>
+#include <string.h>
+#include "hierarchy.h"
+#include "parallel.h"
+
+#define SIMD_KERNELS "hierarchy_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(Hierarchy_LocalKernel);
+
+// nodes per worker chunk, also the size below which the update stays a
+// plain linear pass
+#define HIERARCHY_GRAIN		1024
+
+#define HIERARCHY_BIT(bits, i)	((bits)[(i) >> 5] & (1u << ((i) & 31)))
+#define HIERARCHY_SET(bits, i)	((bits)[(i) >> 5] |= (1u << ((i) & 31)))
+
+/*-----------------------------------------------------------------------------
+	allocation
+-----------------------------------------------------------------------------*/
+
+static int Hierarchy_Align(int numbytes)
+{
+	return (numbytes + SIMD_ALIGN - 1) & ~(SIMD_ALIGN - 1);
+}
+
+hierarchy_t *Hierarchy_Alloc(int maxnodes)
+{
+	hierarchy_t	*h;
+
+	// header in the first alignment blocks, then every array on its own
+	// alignment boundary
+	int headerbytes	= Hierarchy_Align(sizeof(hierarchy_t));
+	int intbytes	= Hierarchy_Align(maxnodes * sizeof(int));
+	int floatbytes	= Hierarchy_Align(maxnodes * sizeof(float));
+	int matbytes	= Hierarchy_Align(maxnodes * sizeof(mat3x4));
+	int maskbytes	= Hierarchy_Align(((maxnodes + 31) >> 5) * sizeof(unsigned int));
+	int levelbytes	= Hierarchy_Align((maxnodes + 1) * sizeof(int));
+
+	int numbytes = headerbytes + (3 * intbytes) + (10 * floatbytes) + (2 * matbytes) + (2 * maskbytes) + levelbytes;
+	h = (hierarchy_t*)Simd_AlignedAlloc(numbytes);
+	if(!h)
+		return NULL;
+
+	char *p = (char*)h + headerbytes;
+
+	h->maxnodes	= maxnodes;
+	h->numnodes	= 0;
+
+	h->parent	= (int*)p;		p += intbytes;
+	h->depth	= (int*)p;		p += intbytes;
+	h->levelnodes	= (int*)p;		p += intbytes;
+	h->qx		= (float*)p;		p += floatbytes;
+	h->qy		= (float*)p;		p += floatbytes;
+	h->qz		= (float*)p;		p += floatbytes;
+	h->qw		= (float*)p;		p += floatbytes;
+	h->tx		= (float*)p;		p += floatbytes;
+	h->ty		= (float*)p;		p += floatbytes;
+	h->tz		= (float*)p;		p += floatbytes;
+	h->sx		= (float*)p;		p += floatbytes;
+	h->sy		= (float*)p;		p += floatbytes;
+	h->sz		= (float*)p;		p += floatbytes;
+	h->local	= (mat3x4*)p;		p += matbytes;
+	h->world	= (mat3x4*)p;		p += matbytes;
+	h->dirty	= (unsigned int*)p;	p += maskbytes;
+	h->changed	= (unsigned int*)p;	p += maskbytes;
+	h->levelstart	= (int*)p;
+
+	memset(h->dirty, 0, maskbytes);
+	memset(h->changed, 0, maskbytes);
+
+	h->levelsvalid	= false;
+	h->numlevels	= 0;
+
+	return h;
+}
+
+void Hierarchy_Free(hierarchy_t *h)
+{
+	Simd_AlignedFree(h);
+}
+
+int Hierarchy_AddNode(hierarchy_t *h, int parent)
+{
+	assert(h->numnodes < h->maxnodes);
+	assert(parent < h->numnodes);
+
+	int i = h->numnodes++;
+
+	h->parent[i]	= parent;
+	h->depth[i]	= (parent < 0) ? 0 : h->depth[parent] + 1;
+
+	Hierarchy_SetLocal(h, i, vec4(0.0f, 0.0f, 0.0f, 1.0f), vec3_zero, vec3(1.0f, 1.0f, 1.0f));
+
+	h->levelsvalid = false;
+
+	return i;
+}
+
+void Hierarchy_SetLocal(hierarchy_t *h, int node, const vec4& q, const vec3& t, const vec3& s)
+{
+	h->qx[node] = q.x;
+	h->qy[node] = q.y;
+	h->qz[node] = q.z;
+	h->qw[node] = q.w;
+
+	h->tx[node] = t.x;
+	h->ty[node] = t.y;
+	h->tz[node] = t.z;
+
+	h->sx[node] = s.x;
+	h->sy[node] = s.y;
+	h->sz[node] = s.z;
+
+	HIERARCHY_SET(h->dirty, node);
+}
+
+/*-----------------------------------------------------------------------------
+	update
+-----------------------------------------------------------------------------*/
+
+// counting sort of the nodes by depth, each level is independent
+static void Hierarchy_BuildLevels(hierarchy_t *h)
+{
+	int *start = h->levelstart;
+
+	h->numlevels = 0;
+	for(int i = 0; i < h->numnodes; i++)
+	{
+		if(h->depth[i] + 1 > h->numlevels)
+			h->numlevels = h->depth[i] + 1;
+	}
+
+	memset(start, 0, (h->numlevels + 1) * sizeof(int));
+
+	for(int i = 0; i < h->numnodes; i++)
+		start[h->depth[i] + 1]++;
+
+	for(int l = 0; l < h->numlevels; l++)
+		start[l + 1] += start[l];
+
+	// fill with each level start as its cursor, which leaves every start on
+	// the end of its level, then shift them back
+	for(int i = 0; i < h->numnodes; i++)
+		h->levelnodes[start[h->depth[i]]++] = i;
+
+	for(int l = h->numlevels; l > 0; l--)
+		start[l] = start[l - 1];
+	start[0] = 0;
+
+	h->levelsvalid = true;
+}
+
+static void Hierarchy_LocalChunk(void *context, int start, int end)
+{
+	hierarchy_t *h = (hierarchy_t*)context;
+
+	int i = SIMD_CALL(Hierarchy_LocalKernel)(h->local, h, start, end);
+	Hierarchy_LocalKernel_scalar(h->local, h, i, end);
+}
+
+static inline void Hierarchy_WorldMatrix(hierarchy_t *h, int i)
+{
+	int p = h->parent[i];
+
+	h->world[i] = (p < 0) ? h->local[i] : h->world[p] * h->local[i];
+}
+
+typedef struct hierarchy_leveljob_s
+{
+	hierarchy_t	*h;
+	const int	*nodes;
+
+} hierarchy_leveljob_t;
+
+static void Hierarchy_LevelChunk(void *context, int start, int end)
+{
+	hierarchy_leveljob_t *job = (hierarchy_leveljob_t*)context;
+
+	for(int i = start; i < end; i++)
+		Hierarchy_WorldMatrix(job->h, job->nodes[i]);
+}
+
+void Hierarchy_Update(hierarchy_t *h)
+{
+	Parallel_For(h->numnodes, HIERARCHY_GRAIN, Hierarchy_LocalChunk, h);
+
+	if(h->numnodes <= HIERARCHY_GRAIN)
+	{
+		for(int i = 0; i < h->numnodes; i++)
+			Hierarchy_WorldMatrix(h, i);
+	}
+	else
+	{
+		if(!h->levelsvalid)
+			Hierarchy_BuildLevels(h);
+
+		for(int l = 0; l < h->numlevels; l++)
+		{
+			hierarchy_leveljob_t job;
+
+			job.h		= h;
+			job.nodes	= h->levelnodes + h->levelstart[l];
+
+			Parallel_For(h->levelstart[l + 1] - h->levelstart[l], HIERARCHY_GRAIN, Hierarchy_LevelChunk, &job);
+		}
+	}
+
+	memset(h->dirty, 0, ((h->numnodes + 31) >> 5) * sizeof(unsigned int));
+}
+
+void Hierarchy_UpdateDirty(hierarchy_t *h)
+{
+	int numwords = (h->numnodes + 31) >> 5;
+
+	// parents come first, so a node sees whether its parent moved this pass
+	for(int i = 0; i < h->numnodes; i++)
+	{
+		int p = h->parent[i];
+		bool dirty = HIERARCHY_BIT(h->dirty, i) != 0;
+
+		if(!dirty && (p < 0 || !HIERARCHY_BIT(h->changed, p)))
+			continue;
+
+		if(dirty)
+			Hierarchy_LocalKernel_scalar(h->local, h, i, i + 1);
+
+		Hierarchy_WorldMatrix(h, i);
+		HIERARCHY_SET(h->changed, i);
+	}
+
+	memset(h->dirty, 0, numwords * sizeof(unsigned int));
+	memset(h->changed, 0, numwords * sizeof(unsigned int));
+}
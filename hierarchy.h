@@ -0,0 +1,67 @@
+/*=============================================================================
+	hierarchy.h
+============================================================================*/
+
+#ifndef __HIERARCHY_H__
+#define __HIERARCHY_H__
+
+#include "vector.h"
+#include "matrix.h"
+
+/*-----------------------------------------------------------------------------
+	hierarchy_t
+
+	flattened transform hierarchy. nodes are stored in topological order,
+	every parent index is less than the index of its child, so the world
+	matrices come out of one forward pass over the arrays. local transforms
+	are kept as structure-of-arrays rotation, translation and per-axis scale,
+	applied as scale, then rotation, then translation.
+-----------------------------------------------------------------------------*/
+
+typedef struct hierarchy_s
+{
+	int		maxnodes;
+	int		numnodes;
+
+	int		*parent;	// -1 for roots
+	int		*depth;
+
+	// local rotation quaternion x y z w, translation and scale
+	float		*qx, *qy, *qz, *qw;
+	float		*tx, *ty, *tz;
+	float		*sx, *sy, *sz;
+
+	mat3x4		*local;
+	mat3x4		*world;
+
+	// one bit per node, set when its local transform changes
+	unsigned int	*dirty;
+	unsigned int	*changed;
+
+	// nodes grouped by depth for the parallel update, rebuilt on demand
+	bool		levelsvalid;
+	int		numlevels;
+	int		*levelstart;
+	int		*levelnodes;
+
+} hierarchy_t;
+
+hierarchy_t *Hierarchy_Alloc(int maxnodes);
+void Hierarchy_Free(hierarchy_t *h);
+
+// append a node below parent, or a root for -1. the local transform starts
+// as the identity. returns the node index
+int Hierarchy_AddNode(hierarchy_t *h, int parent);
+
+// q is x y z w and must be unit length. marks the node dirty
+void Hierarchy_SetLocal(hierarchy_t *h, int node, const vec4& q, const vec3& t, const vec3& s);
+
+// rebuild every world matrix. large hierarchies are updated a depth level at
+// a time with the nodes of each level split across the worker threads
+void Hierarchy_Update(hierarchy_t *h);
+
+// rebuild only the dirty nodes and everything below them, then clear the
+// dirty bits
+void Hierarchy_UpdateDirty(hierarchy_t *h);
+
+#endif
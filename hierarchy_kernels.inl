@@ -0,0 +1,66 @@
+/*=============================================================================
+	hierarchy_kernels.inl
+
+	per-tier local matrix build, see simd_variants.h. SIMD_WIDTH nodes are
+	converted from the soa quaternion, translation and scale planes, then
+	transposed out to mat3x4s. this is JointToMatrix with the scale folded
+	into the columns
+-----------------------------------------------------------------------------*/
+
+static int SIMD_FN(Hierarchy_LocalKernel)(mat3x4 *out, const hierarchy_t *h, int start, int end)
+{
+	int	i;
+	float	packet[12 * SIMD_WIDTH];
+	vfloat	m[12];
+
+	vfloat one = VF_SET1(1.0f);
+	vfloat two = VF_SET1(2.0f);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat x = VF_LOADU(h->qx + i);
+		vfloat y = VF_LOADU(h->qy + i);
+		vfloat z = VF_LOADU(h->qz + i);
+		vfloat w = VF_LOADU(h->qw + i);
+
+		vfloat sx = VF_LOADU(h->sx + i);
+		vfloat sy = VF_LOADU(h->sy + i);
+		vfloat sz = VF_LOADU(h->sz + i);
+
+		vfloat x2 = VF_MUL(x, two);
+		vfloat y2 = VF_MUL(y, two);
+		vfloat z2 = VF_MUL(z, two);
+
+		vfloat xx = VF_MUL(x, x2), xy = VF_MUL(x, y2), xz = VF_MUL(x, z2), xw = VF_MUL(w, x2);
+		vfloat yy = VF_MUL(y, y2), yz = VF_MUL(y, z2), yw = VF_MUL(w, y2);
+		vfloat zz = VF_MUL(z, z2), zw = VF_MUL(w, z2);
+
+		m[0]	= VF_MUL(VF_SUB(one, VF_ADD(yy, zz)), sx);
+		m[1]	= VF_MUL(VF_SUB(xy, zw), sy);
+		m[2]	= VF_MUL(VF_ADD(xz, yw), sz);
+		m[3]	= VF_LOADU(h->tx + i);
+
+		m[4]	= VF_MUL(VF_ADD(xy, zw), sx);
+		m[5]	= VF_MUL(VF_SUB(one, VF_ADD(xx, zz)), sy);
+		m[6]	= VF_MUL(VF_SUB(yz, xw), sz);
+		m[7]	= VF_LOADU(h->ty + i);
+
+		m[8]	= VF_MUL(VF_SUB(xz, yw), sx);
+		m[9]	= VF_MUL(VF_ADD(yz, xw), sy);
+		m[10]	= VF_MUL(VF_SUB(one, VF_ADD(xx, yy)), sz);
+		m[11]	= VF_LOADU(h->tz + i);
+
+		for(int e = 0; e < 12; e++)
+			VF_STOREU(packet + (e * SIMD_WIDTH), m[e]);
+
+		for(int k = 0; k < SIMD_WIDTH; k++)
+		{
+			float *f = out[i + k].Ptr();
+
+			for(int e = 0; e < 12; e++)
+				f[e] = packet[(e * SIMD_WIDTH) + k];
+		}
+	}
+
+	return i;
+}
@@ -228,6 +228,10 @@ inline bool operator!=(const mat2x2& b, const mat2x2& a)
 -----------------------------------------------------------------------------*/
 #define MATRIX_INVERSE_EPSILON (0.01f)
 
+// mat3x3 inverses compare the determinant with the product of the row
+// lengths, its largest possible size, so uniform scale does not matter
+#define MATRIX_INVERSE_RELATIVE_EPSILON (1e-6f)
+
 class mat3x3
 {
 public:
@@ -312,6 +316,73 @@ public:
 			m[0][2], m[1][2], m[2][2]
 		);
 	}
+	inline float Determinant() const
+	{
+		return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+			 + m[0][1] * (m[1][2] * m[2][0] - m[1][0] * m[2][2])
+			 + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	}
+
+	// true when det is too small against the rows to invert
+	inline bool IsSingular(float det) const
+	{
+		return fabs(det) <= MATRIX_INVERSE_RELATIVE_EPSILON * Length(m[0]) * Length(m[1]) * Length(m[2]);
+	}
+
+	// the cofactor matrix, rows are the cross products of the other rows.
+	// this is det * the inverse transpose
+	// 18 multiplications
+	inline mat3x3 Cofactor() const
+	{
+		return mat3x3
+		(
+			m[1][1] * m[2][2] - m[1][2] * m[2][1], m[1][2] * m[2][0] - m[1][0] * m[2][2], m[1][0] * m[2][1] - m[1][1] * m[2][0],
+			m[0][2] * m[2][1] - m[0][1] * m[2][2], m[0][0] * m[2][2] - m[0][2] * m[2][0], m[0][1] * m[2][0] - m[0][0] * m[2][1],
+			m[0][1] * m[1][2] - m[0][2] * m[1][1], m[0][2] * m[1][0] - m[0][0] * m[1][2], m[0][0] * m[1][1] - m[0][1] * m[1][0]
+		);
+	}
+
+	// 18+3+9 = 30 multiplications
+	//			1 division
+	//			3 square roots for the singular test
+	bool Invert()
+	{
+		mat3x3 c = Cofactor();
+		float det = m[0][0] * c[0][0] + m[0][1] * c[0][1] + m[0][2] * c[0][2];
+
+		if(IsSingular(det))
+		{
+			return false;
+		}
+
+		c.Transpose();
+		det = 1.0f / det;
+		m[0] = det * c[0];
+		m[1] = det * c[1];
+		m[2] = det * c[2];
+
+		return true;
+	}
+
+	// the normal matrix of a linear transform, without the transpose
+	bool InvertTranspose()
+	{
+		mat3x3 c = Cofactor();
+		float det = m[0][0] * c[0][0] + m[0][1] * c[0][1] + m[0][2] * c[0][2];
+
+		if(IsSingular(det))
+		{
+			return false;
+		}
+
+		det = 1.0f / det;
+		m[0] = det * c[0];
+		m[1] = det * c[1];
+		m[2] = det * c[2];
+
+		return true;
+	}
+
 	inline float* Ptr()
 	{
 		return &m[0].x;
@@ -423,9 +494,9 @@ inline mat3x3 operator*(const mat3x3 a, const mat3x3 b)
 }
 
 // matrix-vector post multiply
-inline vec2 operator*(const mat3x3 m, const vec2 v)
+inline vec3 operator*(const mat3x3 m, const vec3 v)
 {
-	vec2 r;
+	vec3 r;
 
 	r[0] = v[0] * m[0][0] + v[1] * m[0][1] + v[2] * m[0][2];
 	r[1] = v[0] * m[1][0] + v[1] * m[1][1] + v[2] * m[1][2];
@@ -435,9 +506,9 @@ inline vec2 operator*(const mat3x3 m, const vec2 v)
 }
 
 // vector-matrix pre multiply
-inline vec2 operator*(const vec2 v, const mat3x3 m)
+inline vec3 operator*(const vec3 v, const mat3x3 m)
 {
-	vec2 r;
+	vec3 r;
 
 	r[0] = v[0] * m[0][0] + v[1] * m[1][0] + v[2] * m[2][0];
 	r[1] = v[0] * m[0][1] + v[1] * m[1][1] + v[2] * m[2][1];
@@ -448,40 +519,55 @@ inline vec2 operator*(const vec2 v, const mat3x3 m)
 
 inline bool operator==(const mat3x3& b, const mat3x3& a)
 {
-	return (b[0] == a[0]) && (b[1] == a[1]);
+	return (b[0] == a[0]) && (b[1] == a[1]) && (b[2] == a[2]);
 }
 
 inline bool operator!=(const mat3x3& b, const mat3x3& a)
 {
-	return (b[0] != a[0]) || (b[1] != a[1]);
+	return (b[0] != a[0]) || (b[1] != a[1]) || (b[2] != a[2]);
 }
 
 /*-----------------------------------------------------------------------------
 	mat4x4
+
+	the rows are vec4s, so with sse each row lives in one register and the
+	products below are sequences of 4-wide multiply-adds
 -----------------------------------------------------------------------------*/
 #define MATRIX_INVERSE_EPSILON (0.01f)
 
+// Classify results, cheapest inverse last
+#define MATRIX_GENERAL		0	// projective, needs the full cofactor inverse
+#define MATRIX_AFFINE		1	// bottom row is 0 0 0 1
+#define MATRIX_RIGID		2	// affine with an orthonormal rotation
+#define MATRIX_SCALETRANSLATE	3	// affine with a diagonal upper 3x3
+
+// tolerance on the rotation rows for MATRIX_RIGID
+#define MATRIX_RIGID_EPSILON	(1e-4f)
+
+class mat3x4;
+
 class mat4x4
 {
 public:
 
-	vec4 m[3];
+	vec4 m[4];
 
 	// constructors
 	mat4x4()
 	{}
-	mat4x4(vec4 x, vec4 y, vec4 z)
+	mat4x4(vec4 x, vec4 y, vec4 z, vec4 w)
 	{
 		m[0] = x;
 		m[1] = y;
 		m[2] = z;
+		m[3] = w;
 	}
 	mat4x4(float xx, float xy, float xz, float xw, float yx, float yy, float yz, float yw, float zx, float zy, float zz, float zw, float wx, float wy, float wz, float ww)
 	{
 		m[0].x = xx, m[0].y = xy, m[0].z = xz, m[0].w = xw;
 		m[1].x = yx, m[1].y = yy, m[1].z = yz, m[1].w = yw;
 		m[2].x = zx, m[2].y = zy, m[2].z = zz, m[2].w = zw;
-		m[3].x = wx, m[2].y = wy, m[3].z = wz, m[3].w = ww;
+		m[3].x = wx, m[3].y = wy, m[3].z = wz, m[3].w = ww;
 	}
 	mat4x4(float s)
 	{
@@ -552,6 +638,9 @@ public:
 	}
 	inline void Transpose()
 	{
+#ifdef VECTOR_SSE
+		_MM_TRANSPOSE4_PS(m[0].v, m[1].v, m[2].v, m[3].v);
+#else
 		*this = mat4x4
 		(
 			m[0][0], m[1][0], m[2][0], m[3][0],
@@ -559,6 +648,7 @@ public:
 			m[0][2], m[1][2], m[2][2], m[3][2],
 			m[0][3], m[1][3], m[2][3], m[3][3]
 		);
+#endif
 	}
 	inline float* Ptr()
 	{
@@ -669,31 +759,115 @@ public:
 
 		return true;
 	}
+
+	// affine matrices only, the bottom row is written as 0 0 0 1
+
+	// orthonormal rotation plus translation, transposes the rotation
+	// 9 multiplications
+	inline void InvertRigid()
+	{
+		float tx = m[0][3], ty = m[1][3], tz = m[2][3];
+
+		*this = mat4x4
+		(
+			m[0][0], m[1][0], m[2][0], -(m[0][0] * tx + m[1][0] * ty + m[2][0] * tz),
+			m[0][1], m[1][1], m[2][1], -(m[0][1] * tx + m[1][1] * ty + m[2][1] * tz),
+			m[0][2], m[1][2], m[2][2], -(m[0][2] * tx + m[1][2] * ty + m[2][2] * tz),
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	// diagonal scale plus translation, fails on a zero scale
+	// 3 multiplications, 3 divisions
+	inline bool InvertScaleTranslate()
+	{
+		if(m[0][0] == 0.0f || m[1][1] == 0.0f || m[2][2] == 0.0f)
+		{
+			return false;
+		}
+
+		float sx = 1.0f / m[0][0];
+		float sy = 1.0f / m[1][1];
+		float sz = 1.0f / m[2][2];
+
+		*this = mat4x4
+		(
+			sx, 0.0f, 0.0f, -m[0][3] * sx,
+			0.0f, sy, 0.0f, -m[1][3] * sy,
+			0.0f, 0.0f, sz, -m[2][3] * sz,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+
+		return true;
+	}
+
+	// any affine matrix, see mat3x4::Invert
+	// 36 multiplications, 1 division
+	inline bool InvertAffine();
+
+	// exact tests on the bottom row and the off diagonals, the rigid test
+	// checks the rotation rows against MATRIX_RIGID_EPSILON
+	// 18 multiplications at most
+	inline int Classify() const
+	{
+		if(m[3][0] != 0.0f || m[3][1] != 0.0f || m[3][2] != 0.0f || m[3][3] != 1.0f)
+		{
+			return MATRIX_GENERAL;
+		}
+
+		if(m[0][1] == 0.0f && m[0][2] == 0.0f && m[1][0] == 0.0f && m[1][2] == 0.0f && m[2][0] == 0.0f && m[2][1] == 0.0f)
+		{
+			return MATRIX_SCALETRANSLATE;
+		}
+
+		for(int i = 0; i < 3; i++)
+		{
+			for(int j = i; j < 3; j++)
+			{
+				float d = m[i][0] * m[j][0] + m[i][1] * m[j][1] + m[i][2] * m[j][2];
+
+				if(fabs(d - ((i == j) ? 1.0f : 0.0f)) > MATRIX_RIGID_EPSILON)
+				{
+					return MATRIX_AFFINE;
+				}
+			}
+		}
+
+		return MATRIX_RIGID;
+	}
+
+	// invert through the path for a type from Classify
+	inline bool InvertClassified(int type)
+	{
+		switch(type)
+		{
+		case MATRIX_SCALETRANSLATE:
+			return InvertScaleTranslate();
+		case MATRIX_RIGID:
+			InvertRigid();
+			return true;
+		case MATRIX_AFFINE:
+			return InvertAffine();
+		default:
+			return Invert();
+		}
+	}
+
+	// classify and invert, for matrices of unknown origin
+	inline bool InvertAuto()
+	{
+		return InvertClassified(Classify());
+	}
 };
 
 inline mat4x4 operator+(const mat4x4 a, const mat4x4 b)
 {
 	mat4x4 r;
 
-	r[0][0] = a[0][0] + b[0][0];
-	r[0][1] = a[0][1] + b[0][1];
-	r[0][2] = a[0][2] + b[0][2];
-	r[0][3] = a[0][3] + b[0][3];
-
-	r[1][0] = a[1][0] + b[1][0];
-	r[1][1] = a[1][1] + b[1][1];
-	r[1][2] = a[1][2] + b[1][2];
-	r[1][3] = a[1][3] + b[1][3];
-
-	r[2][0] = a[2][0] + b[2][0];
-	r[2][1] = a[2][1] + b[2][1];
-	r[2][2] = a[2][2] + b[2][2];
-	r[2][3] = a[2][3] + b[2][3];
-
-	r[3][0] = a[3][0] + b[3][0];
-	r[3][1] = a[3][1] + b[3][1];
-	r[3][2] = a[3][2] + b[3][2];
-	r[3][3] = a[3][3] + b[3][3];
+	r.m[0] = a.m[0] + b.m[0];
+	r.m[1] = a.m[1] + b.m[1];
+	r.m[2] = a.m[2] + b.m[2];
+	r.m[3] = a.m[3] + b.m[3];
 
 	return r;
 }
@@ -702,25 +876,10 @@ inline mat4x4 operator-(const mat4x4 a, const mat4x4 b)
 {
 	mat4x4 r;
 
-	r[0][0] = a[0][0] - b[0][0];
-	r[0][1] = a[0][1] - b[0][1];
-	r[0][2] = a[0][2] - b[0][2];
-	r[0][3] = a[0][3] - b[0][3];
-
-	r[1][0] = a[1][0] - b[1][0];
-	r[1][1] = a[1][1] - b[1][1];
-	r[1][2] = a[1][2] - b[1][2];
-	r[1][3] = a[1][3] - b[1][3];
-
-	r[2][0] = a[2][0] - b[2][0];
-	r[2][1] = a[2][1] - b[2][1];
-	r[2][2] = a[2][2] - b[2][2];
-	r[2][3] = a[2][3] - b[2][3];
-	
-	r[3][0] = a[3][0] - b[3][0];
-	r[3][1] = a[3][1] - b[3][1];
-	r[3][2] = a[3][2] - b[3][2];
-	r[3][3] = a[3][3] - b[3][3];
+	r.m[0] = a.m[0] - b.m[0];
+	r.m[1] = a.m[1] - b.m[1];
+	r.m[2] = a.m[2] - b.m[2];
+	r.m[3] = a.m[3] - b.m[3];
 
 	return r;
 }
@@ -729,25 +888,10 @@ inline mat4x4 operator*(const float f, const mat4x4 m)
 {
 	mat4x4 r;
 
-	r[0][0] = f * m[0][0];
-	r[0][1] = f * m[0][1];
-	r[0][2] = f * m[0][2];
-	r[0][3] = f * m[0][3];
-
-	r[1][0] = f * m[1][0];
-	r[1][1] = f * m[1][1];
-	r[1][2] = f * m[1][2];
-	r[1][3] = f * m[1][3];
-
-	r[2][0] = f * m[2][0];
-	r[2][1] = f * m[2][1];
-	r[2][2] = f * m[2][2];
-	r[2][3] = f * m[2][3];
-
-	r[3][0] = f * m[3][0];
-	r[3][1] = f * m[3][1];
-	r[3][2] = f * m[3][2];
-	r[3][3] = f * m[3][3];
+	r.m[0] = f * m.m[0];
+	r.m[1] = f * m.m[1];
+	r.m[2] = f * m.m[2];
+	r.m[3] = f * m.m[3];
 
 	return r;
 }
@@ -758,37 +902,39 @@ inline mat4x4 operator*(mat4x4 m, const float f)
 }
 
 // matrix-matrix multiply
+// each row of the result is a combination of the rows of b
 inline mat4x4 operator*(const mat4x4 a, const mat4x4 b)
 {
 	mat4x4 r;
 
-	r[0][0] = a[0][0] * b[0][0] + a[0][1] * b[1][0] + a[0][2] * b[2][0] + a[0][3] * b[3][0];
-	r[0][1] = a[0][0] * b[0][1] + a[0][1] * b[1][1] + a[0][2] * b[2][1] + a[0][3] * b[3][1];
-	r[0][2] = a[0][0] * b[0][2] + a[0][1] * b[1][2] + a[0][2] * b[2][2] + a[0][3] * b[3][2];
-	r[0][3] = a[0][0] * b[0][3] + a[0][1] * b[1][3] + a[0][2] * b[2][3] + a[0][3] * b[3][3];
-
-	r[1][0] = a[1][0] * b[0][0] + a[1][1] * b[1][0] + a[1][2] * b[2][0] + a[1][3] * b[3][0];
-	r[1][1] = a[1][0] * b[0][1] + a[1][1] * b[1][1] + a[1][2] * b[2][1] + a[1][3] * b[3][1];
-	r[1][2] = a[1][0] * b[0][2] + a[1][1] * b[1][2] + a[1][2] * b[2][2] + a[1][3] * b[3][2];
-	r[1][2] = a[1][0] * b[0][3] + a[1][1] * b[1][3] + a[1][2] * b[2][3] + a[1][3] * b[3][3];
-
-	r[2][0] = a[2][0] * b[0][0] + a[2][1] * b[1][0] + a[2][2] * b[2][0] + a[2][3] * b[3][0];
-	r[2][1] = a[2][0] * b[0][1] + a[2][1] * b[1][1] + a[2][2] * b[2][1] + a[2][3] * b[3][1];
-	r[2][2] = a[2][0] * b[0][2] + a[2][1] * b[1][2] + a[2][2] * b[2][2] + a[2][3] * b[3][2];
-	r[2][3] = a[2][0] * b[0][3] + a[2][1] * b[1][3] + a[2][2] * b[2][3] + a[2][3] * b[3][3];
+	for(int i = 0; i < 4; i++)
+	{
+		vec4 row = a.m[i].x * b.m[0];
+		row = MulAdd(row, a.m[i].y, b.m[1]);
+		row = MulAdd(row, a.m[i].z, b.m[2]);
+		row = MulAdd(row, a.m[i].w, b.m[3]);
 
-	r[3][0] = a[3][0] * b[0][0] + a[3][1] * b[1][0] + a[3][2] * b[2][0] + a[3][3] * b[3][0];
-	r[3][1] = a[3][0] * b[0][1] + a[3][1] * b[1][1] + a[3][2] * b[2][1] + a[3][3] * b[3][1];
-	r[3][2] = a[3][0] * b[0][2] + a[3][1] * b[1][2] + a[3][2] * b[2][2] + a[3][3] * b[3][2];
-	r[3][3] = a[3][0] * b[0][3] + a[3][1] * b[1][3] + a[3][2] * b[2][3] + a[3][3] * b[3][3];
+		r.m[i] = row;
+	}
 
 	return r;
 }
 
 // matrix-vector post multiply
-inline vec2 operator*(const mat4x4 m, const vec2 v)
+inline vec4 operator*(const mat4x4 m, const vec4 v)
 {
-	vec2 r;
+#ifdef VECTOR_SSE
+	__m128 x = _mm_mul_ps(m.m[0].v, v.v);
+	__m128 y = _mm_mul_ps(m.m[1].v, v.v);
+	__m128 z = _mm_mul_ps(m.m[2].v, v.v);
+	__m128 w = _mm_mul_ps(m.m[3].v, v.v);
+
+	// sum each row product horizontally
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+
+	return vec4(_mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w)));
+#else
+	vec4 r;
 
 	r[0] = v[0] * m[0][0] + v[1] * m[0][1] + v[2] * m[0][2] + v[3] * m[0][3];
 	r[1] = v[0] * m[1][0] + v[1] * m[1][1] + v[2] * m[1][2] + v[3] * m[1][3];
@@ -796,30 +942,308 @@ inline vec2 operator*(const mat4x4 m, const vec2 v)
 	r[3] = v[0] * m[3][0] + v[1] * m[3][1] + v[2] * m[3][2] + v[3] * m[3][3];
 
 	return r;
+#endif
 }
 
 // vector-matrix pre multiply
-inline vec2 operator*(const vec2 v, const mat4x4 m)
+inline vec4 operator*(const vec4 v, const mat4x4 m)
 {
-	vec2 r;
-
-	r[0] = v[0] * m[0][0] + v[1] * m[1][0] + v[2] * m[2][0] + v[3] * m[3][0];
-	r[1] = v[0] * m[0][1] + v[1] * m[1][1] + v[2] * m[2][1] + v[3] * m[3][1];
-	r[2] = v[0] * m[0][2] + v[1] * m[1][2] + v[2] * m[2][2] + v[3] * m[3][2];
-	r[3] = v[0] * m[0][3] + v[1] * m[1][3] + v[2] * m[2][3] + v[3] * m[3][3];
+	vec4 r = v.x * m.m[0];
+	r = MulAdd(r, v.y, m.m[1]);
+	r = MulAdd(r, v.z, m.m[2]);
+	r = MulAdd(r, v.w, m.m[3]);
 
 	return r;
 }
 
 inline bool operator==(const mat4x4& b, const mat4x4& a)
 {
-	return (b[0] == a[0]) && (b[1] == a[1]);
+	return (b[0] == a[0]) && (b[1] == a[1]) && (b[2] == a[2]) && (b[3] == a[3]);
 }
 
 inline bool operator!=(const mat4x4& b, const mat4x4& a)
 {
-	return (b[0] != a[0]) || (b[1] != a[1]);
+	return (b[0] != a[0]) || (b[1] != a[1]) || (b[2] != a[2]) || (b[3] != a[3]);
 }
 
-#endif
+/*-----------------------------------------------------------------------------
+	mat3x4
+
+	affine transform kept as the top three rows of a mat4x4, the bottom row
+	is implied to be 0 0 0 1. this is the md5jointmat_t layout, products cost
+	36 multiplies instead of 64 and the inverses skip the cofactor expansion
+-----------------------------------------------------------------------------*/
+
+class mat3x4
+{
+public:
+
+	vec4 m[3];
 
+	// constructors
+	mat3x4()
+	{}
+	mat3x4(vec4 x, vec4 y, vec4 z)
+	{
+		m[0] = x;
+		m[1] = y;
+		m[2] = z;
+	}
+	mat3x4(float xx, float xy, float xz, float xw, float yx, float yy, float yz, float yw, float zx, float zy, float zz, float zw)
+	{
+		m[0].x = xx, m[0].y = xy, m[0].z = xz, m[0].w = xw;
+		m[1].x = yx, m[1].y = yy, m[1].z = yz, m[1].w = yw;
+		m[2].x = zx, m[2].y = zy, m[2].z = zz, m[2].w = zw;
+	}
+	mat3x4(const mat3x3& r, const vec3& t)
+	{
+		m[0].x = r[0][0], m[0].y = r[0][1], m[0].z = r[0][2], m[0].w = t.x;
+		m[1].x = r[1][0], m[1].y = r[1][1], m[1].z = r[1][2], m[1].w = t.y;
+		m[2].x = r[2][0], m[2].y = r[2][1], m[2].z = r[2][2], m[2].w = t.z;
+	}
+
+	// drops the bottom row
+	explicit mat3x4(const mat4x4& a)
+	{
+		m[0] = a.m[0];
+		m[1] = a.m[1];
+		m[2] = a.m[2];
+	}
+
+	// functions
+	inline void SetRow(int i, float x, float y, float z, float w)
+	{
+		m[i][0] = x;
+		m[i][1] = y;
+		m[i][2] = z;
+		m[i][3] = w;
+	}
+	inline void Zero()
+	{
+		m[0].Set(0.0, 0.0, 0.0, 0.0);
+		m[1].Set(0.0, 0.0, 0.0, 0.0);
+		m[2].Set(0.0, 0.0, 0.0, 0.0);
+	}
+	inline void Identity()
+	{
+		m[0].Set(1.0f, 0.0f, 0.0f, 0.0f);
+		m[1].Set(0.0f, 1.0f, 0.0f, 0.0f);
+		m[2].Set(0.0f, 0.0f, 1.0f, 0.0f);
+	}
+	inline mat3x3 Rotation() const
+	{
+		return mat3x3
+		(
+			m[0].x, m[0].y, m[0].z,
+			m[1].x, m[1].y, m[1].z,
+			m[2].x, m[2].y, m[2].z
+		);
+	}
+	inline vec3 Translation() const
+	{
+		return vec3(m[0].w, m[1].w, m[2].w);
+	}
+	inline void SetTranslation(const vec3& t)
+	{
+		m[0].w = t.x;
+		m[1].w = t.y;
+		m[2].w = t.z;
+	}
+	inline mat4x4 ToMat4x4() const
+	{
+		return mat4x4(m[0], m[1], m[2], vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	// w = 1, picks up the translation
+	inline vec3 TransformPoint(const vec3& v) const
+	{
+		return vec3
+		(
+			m[0].x * v.x + m[0].y * v.y + m[0].z * v.z + m[0].w,
+			m[1].x * v.x + m[1].y * v.y + m[1].z * v.z + m[1].w,
+			m[2].x * v.x + m[2].y * v.y + m[2].z * v.z + m[2].w
+		);
+	}
+
+	// w = 0, rotation and scale only
+	inline vec3 TransformVector(const vec3& v) const
+	{
+		return vec3
+		(
+			m[0].x * v.x + m[0].y * v.y + m[0].z * v.z,
+			m[1].x * v.x + m[1].y * v.y + m[1].z * v.z,
+			m[2].x * v.x + m[2].y * v.y + m[2].z * v.z
+		);
+	}
+
+	// rotation and translation only, the rotation is transposed
+	// 9 multiplications
+	inline void InvertRigid()
+	{
+		vec3 t = Translation();
+
+		*this = mat3x4
+		(
+			m[0].x, m[1].x, m[2].x, -(m[0].x * t.x + m[1].x * t.y + m[2].x * t.z),
+			m[0].y, m[1].y, m[2].y, -(m[0].y * t.x + m[1].y * t.y + m[2].y * t.z),
+			m[0].z, m[1].z, m[2].z, -(m[0].z * t.x + m[1].z * t.y + m[2].z * t.z)
+		);
+	}
+
+	// rotation with a scale per axis. each column is divided by its squared
+	// length before the transpose, fails on a zero length axis
+	// 27 multiplications, 3 divisions
+	inline bool InvertScaled()
+	{
+		vec3	t = Translation();
+		float	s[3];
+
+		for(int i = 0; i < 3; i++)
+		{
+			float lengthsqr = m[0][i] * m[0][i] + m[1][i] * m[1][i] + m[2][i] * m[2][i];
+
+			if(lengthsqr == 0.0f)
+			{
+				return false;
+			}
+
+			s[i] = 1.0f / lengthsqr;
+		}
+
+		mat3x4 r;
+
+		for(int i = 0; i < 3; i++)
+		{
+			float x = m[0][i] * s[i];
+			float y = m[1][i] * s[i];
+			float z = m[2][i] * s[i];
+
+			r.m[i].Set(x, y, z, -(x * t.x + y * t.y + z * t.z));
+		}
+
+		*this = r;
+
+		return true;
+	}
+
+	// any invertible affine transform, 3x3 cofactors plus the translation
+	// 36 multiplications, 1 division
+	bool Invert()
+	{
+		float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+		float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+		float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+
+		float det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+
+		if(fabs(det) < MATRIX_INVERSE_EPSILON)
+		{
+			return false;
+		}
+
+		float invdet = 1.0f / det;
+		vec3 t = Translation();
+
+		mat3x4 r;
+
+		r.m[0].x = c00 * invdet;
+		r.m[1].x = c01 * invdet;
+		r.m[2].x = c02 * invdet;
+
+		r.m[0].y = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invdet;
+		r.m[1].y = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invdet;
+		r.m[2].y = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invdet;
+
+		r.m[0].z = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invdet;
+		r.m[1].z = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invdet;
+		r.m[2].z = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invdet;
+
+		for(int i = 0; i < 3; i++)
+		{
+			r.m[i].w = -(r.m[i].x * t.x + r.m[i].y * t.y + r.m[i].z * t.z);
+		}
+
+		*this = r;
+
+		return true;
+	}
+
+	inline float* Ptr()
+	{
+		return &m[0].x;
+	}
+	inline const float* Ptr() const
+	{
+		return &m[0].x;
+	}
+
+	// read from an indexed row
+	inline vec4 operator[](int i) const
+	{
+		return m[i];
+	}
+
+	// write to an indexed row
+	inline vec4& operator[](int i)
+	{
+		return m[i];
+	}
+};
+
+// affine compose, a applied after b
+// 36 multiplications
+inline mat3x4 operator*(const mat3x4 a, const mat3x4 b)
+{
+	mat3x4 r;
+
+	for(int i = 0; i < 3; i++)
+	{
+		vec4 row = a.m[i].x * b.m[0];
+		row = MulAdd(row, a.m[i].y, b.m[1]);
+		row = MulAdd(row, a.m[i].z, b.m[2]);
+		row.w += a.m[i].w;
+
+		r.m[i] = row;
+	}
+
+	return r;
+}
+
+// homogeneous post multiply, the result keeps v.w
+inline vec4 operator*(const mat3x4 m, const vec4 v)
+{
+	vec4 r;
+
+	r[0] = v[0] * m[0][0] + v[1] * m[0][1] + v[2] * m[0][2] + v[3] * m[0][3];
+	r[1] = v[0] * m[1][0] + v[1] * m[1][1] + v[2] * m[1][2] + v[3] * m[1][3];
+	r[2] = v[0] * m[2][0] + v[1] * m[2][1] + v[2] * m[2][2] + v[3] * m[2][3];
+	r[3] = v[3];
+
+	return r;
+}
+
+inline bool operator==(const mat3x4& b, const mat3x4& a)
+{
+	return (b[0] == a[0]) && (b[1] == a[1]) && (b[2] == a[2]);
+}
+
+inline bool operator!=(const mat3x4& b, const mat3x4& a)
+{
+	return (b[0] != a[0]) || (b[1] != a[1]) || (b[2] != a[2]);
+}
+
+inline bool mat4x4::InvertAffine()
+{
+	mat3x4 a(*this);
+
+	if(!a.Invert())
+	{
+		return false;
+	}
+
+	*this = a.ToMat4x4();
+
+	return true;
+}
+
+#endif
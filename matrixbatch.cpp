@@ -0,0 +1,86 @@
+#include <string.h>
+#include "matrixbatch.h"
+#include "parallel.h"
+
+#define SIMD_KERNELS "matrixbatch_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(MatrixBatch_InvertKernel);
+SIMD_DISPATCH(MatrixBatch_NormalKernel);
+
+// matrices per worker chunk, a multiple of 32 so that chunks never share a
+// word of the singular mask
+#define MATRIXBATCH_GRAIN	1024
+
+typedef struct matrixbatch_job_s
+{
+	mat4x4		*out;
+	const mat4x4	*in;
+	unsigned int	*singular;
+
+	// normal matrices
+	mat3x3		*normals;
+	const float	*rows;
+	int		rowstride;
+
+} matrixbatch_job_t;
+
+static void MatrixBatch_InvertChunk(void *context, int start, int end)
+{
+	matrixbatch_job_t *job = (matrixbatch_job_t*)context;
+
+	int i = SIMD_CALL(MatrixBatch_InvertKernel)(job->out, job->in, job->singular, start, end);
+	MatrixBatch_InvertKernel_scalar(job->out, job->in, job->singular, i, end);
+}
+
+int MatrixBatch_Invert(mat4x4 *out, const mat4x4 *in, int nummatrices, unsigned int *singular)
+{
+	matrixbatch_job_t	job;
+	int			numwords = MATRIXBATCH_MASKWORDS(nummatrices);
+	int			count = 0;
+
+	memset(singular, 0, numwords * sizeof(unsigned int));
+
+	job.out		= out;
+	job.in		= in;
+	job.singular	= singular;
+
+	Parallel_For(nummatrices, MATRIXBATCH_GRAIN, MatrixBatch_InvertChunk, &job);
+
+	for(int i = 0; i < numwords; i++)
+	{
+		for(unsigned int bits = singular[i]; bits; bits &= bits - 1)
+			count++;
+	}
+
+	return count;
+}
+
+static void MatrixBatch_NormalChunk(void *context, int start, int end)
+{
+	matrixbatch_job_t *job = (matrixbatch_job_t*)context;
+
+	int i = SIMD_CALL(MatrixBatch_NormalKernel)(job->normals, job->rows, job->rowstride, start, end);
+	MatrixBatch_NormalKernel_scalar(job->normals, job->rows, job->rowstride, i, end);
+}
+
+static void MatrixBatch_RunNormals(mat3x3 *out, const float *rows, int rowstride, int nummatrices)
+{
+	matrixbatch_job_t job;
+
+	job.normals	= out;
+	job.rows	= rows;
+	job.rowstride	= rowstride;
+
+	Parallel_For(nummatrices, MATRIXBATCH_GRAIN, MatrixBatch_NormalChunk, &job);
+}
+
+void MatrixBatch_NormalMatrices(mat3x3 *out, const mat4x4 *in, int nummatrices)
+{
+	MatrixBatch_RunNormals(out, in->Ptr(), sizeof(mat4x4) / sizeof(float), nummatrices);
+}
+
+void MatrixBatch_NormalMatrices(mat3x3 *out, const mat3x4 *in, int nummatrices)
+{
+	MatrixBatch_RunNormals(out, in->Ptr(), sizeof(mat3x4) / sizeof(float), nummatrices);
+}
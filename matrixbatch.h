@@ -0,0 +1,40 @@
+/*=============================================================================
+	matrixbatch.h
+============================================================================*/
+
+#ifndef __MATRIXBATCH_H__
+#define __MATRIXBATCH_H__
+
+#include "vector.h"
+#include "matrix.h"
+
+// words needed for a per-matrix bitmask
+#define MATRIXBATCH_MASKWORDS(n)	(((n) + 31) >> 5)
+
+/*-----------------------------------------------------------------------------
+	batch inverse
+
+	the same cofactor expansion and MATRIX_INVERSE_EPSILON test as
+	mat4x4::Invert, run on several matrices per simd register in single
+	precision. bit i of singular is set when matrix i could not be inverted,
+	that output is a copy of its input. singular must hold
+	MATRIXBATCH_MASKWORDS(nummatrices) words. out may equal in. returns the
+	number of singular matrices
+-----------------------------------------------------------------------------*/
+
+int MatrixBatch_Invert(mat4x4 *out, const mat4x4 *in, int nummatrices, unsigned int *singular);
+
+/*-----------------------------------------------------------------------------
+	normal matrices
+
+	the inverse transpose of the upper 3x3 of each world matrix, for
+	transforming normals. the translation is ignored. a determinant under
+	MATRIX_INVERSE_RELATIVE_EPSILON times the row lengths, where
+	mat3x3::InvertTranspose fails, gives the cofactor matrix instead. it is the same up to scale and stays usable
+	for normals that are renormalized afterwards
+-----------------------------------------------------------------------------*/
+
+void MatrixBatch_NormalMatrices(mat3x3 *out, const mat4x4 *in, int nummatrices);
+void MatrixBatch_NormalMatrices(mat3x3 *out, const mat3x4 *in, int nummatrices);
+
+#endif
@@ -0,0 +1,204 @@
+/*=============================================================================
+	matrixbatch_kernels.inl
+
+	per-tier batch inverses, see simd_variants.h. SIMD_WIDTH matrices are
+	transposed into a packet with one register per element, so every lane
+	runs the cofactor expansion for its own matrix
+-----------------------------------------------------------------------------*/
+
+static inline vfloat SIMD_FN(MatrixBatch_Det2)(vfloat a, vfloat b, vfloat c, vfloat d)
+{
+	return VF_SUB(VF_MUL(a, b), VF_MUL(c, d));
+}
+
+static inline vfloat SIMD_FN(MatrixBatch_Det3)(vfloat a, vfloat x, vfloat b, vfloat y, vfloat c, vfloat z)
+{
+	return VF_FMADD(c, z, VF_SUB(VF_MUL(a, x), VF_MUL(b, y)));
+}
+
+#define DET2	SIMD_FN(MatrixBatch_Det2)
+#define DET3	SIMD_FN(MatrixBatch_Det3)
+
+static int SIMD_FN(MatrixBatch_InvertKernel)(mat4x4 *out, const mat4x4 *in, unsigned int *singular, int start, int end)
+{
+	int	i;
+	float	packet[16 * SIMD_WIDTH];
+	vfloat	m[4][4];
+	vfloat	r[4][4];
+
+	vfloat epsilon = VF_SET1(MATRIX_INVERSE_EPSILON);
+	vfloat one = VF_SET1(1.0f);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		// aos to one register per element
+		for(int k = 0; k < SIMD_WIDTH; k++)
+		{
+			const float *f = in[i + k].Ptr();
+
+			for(int e = 0; e < 16; e++)
+				packet[(e * SIMD_WIDTH) + k] = f[e];
+		}
+
+		for(int e = 0; e < 16; e++)
+			m[e >> 2][e & 3] = VF_LOADU(packet + (e * SIMD_WIDTH));
+
+		// 2x2 sub-determinants required to calculate 4x4 determinant
+		vfloat det2_01_01 = DET2(m[0][0], m[1][1], m[0][1], m[1][0]);
+		vfloat det2_01_02 = DET2(m[0][0], m[1][2], m[0][2], m[1][0]);
+		vfloat det2_01_03 = DET2(m[0][0], m[1][3], m[0][3], m[1][0]);
+		vfloat det2_01_12 = DET2(m[0][1], m[1][2], m[0][2], m[1][1]);
+		vfloat det2_01_13 = DET2(m[0][1], m[1][3], m[0][3], m[1][1]);
+		vfloat det2_01_23 = DET2(m[0][2], m[1][3], m[0][3], m[1][2]);
+
+		// 3x3 sub-determinants required to calculate 4x4 determinant
+		vfloat det3_201_012 = DET3(m[2][0], det2_01_12, m[2][1], det2_01_02, m[2][2], det2_01_01);
+		vfloat det3_201_013 = DET3(m[2][0], det2_01_13, m[2][1], det2_01_03, m[2][3], det2_01_01);
+		vfloat det3_201_023 = DET3(m[2][0], det2_01_23, m[2][2], det2_01_03, m[2][3], det2_01_02);
+		vfloat det3_201_123 = DET3(m[2][1], det2_01_23, m[2][2], det2_01_13, m[2][3], det2_01_12);
+
+		vfloat det = VF_SUB(VF_MUL(det3_201_023, m[3][1]), VF_MUL(det3_201_123, m[3][0]));
+		det = VF_SUB(det, VF_MUL(det3_201_013, m[3][2]));
+		det = VF_FMADD(det3_201_012, m[3][3], det);
+
+		vmask bad = VF_CMPLT(VF_ABS(det), epsilon);
+		vfloat invdet = VF_DIV(one, VF_SELECT(bad, one, det));
+
+		// remaining 2x2 sub-determinants
+		vfloat det2_03_01 = DET2(m[0][0], m[3][1], m[0][1], m[3][0]);
+		vfloat det2_03_02 = DET2(m[0][0], m[3][2], m[0][2], m[3][0]);
+		vfloat det2_03_03 = DET2(m[0][0], m[3][3], m[0][3], m[3][0]);
+		vfloat det2_03_12 = DET2(m[0][1], m[3][2], m[0][2], m[3][1]);
+		vfloat det2_03_13 = DET2(m[0][1], m[3][3], m[0][3], m[3][1]);
+		vfloat det2_03_23 = DET2(m[0][2], m[3][3], m[0][3], m[3][2]);
+
+		vfloat det2_13_01 = DET2(m[1][0], m[3][1], m[1][1], m[3][0]);
+		vfloat det2_13_02 = DET2(m[1][0], m[3][2], m[1][2], m[3][0]);
+		vfloat det2_13_03 = DET2(m[1][0], m[3][3], m[1][3], m[3][0]);
+		vfloat det2_13_12 = DET2(m[1][1], m[3][2], m[1][2], m[3][1]);
+		vfloat det2_13_13 = DET2(m[1][1], m[3][3], m[1][3], m[3][1]);
+		vfloat det2_13_23 = DET2(m[1][2], m[3][3], m[1][3], m[3][2]);
+
+		// remaining 3x3 sub-determinants
+		vfloat det3_203_012 = DET3(m[2][0], det2_03_12, m[2][1], det2_03_02, m[2][2], det2_03_01);
+		vfloat det3_203_013 = DET3(m[2][0], det2_03_13, m[2][1], det2_03_03, m[2][3], det2_03_01);
+		vfloat det3_203_023 = DET3(m[2][0], det2_03_23, m[2][2], det2_03_03, m[2][3], det2_03_02);
+		vfloat det3_203_123 = DET3(m[2][1], det2_03_23, m[2][2], det2_03_13, m[2][3], det2_03_12);
+
+		vfloat det3_213_012 = DET3(m[2][0], det2_13_12, m[2][1], det2_13_02, m[2][2], det2_13_01);
+		vfloat det3_213_013 = DET3(m[2][0], det2_13_13, m[2][1], det2_13_03, m[2][3], det2_13_01);
+		vfloat det3_213_023 = DET3(m[2][0], det2_13_23, m[2][2], det2_13_03, m[2][3], det2_13_02);
+		vfloat det3_213_123 = DET3(m[2][1], det2_13_23, m[2][2], det2_13_13, m[2][3], det2_13_12);
+
+		vfloat det3_301_012 = DET3(m[3][0], det2_01_12, m[3][1], det2_01_02, m[3][2], det2_01_01);
+		vfloat det3_301_013 = DET3(m[3][0], det2_01_13, m[3][1], det2_01_03, m[3][3], det2_01_01);
+		vfloat det3_301_023 = DET3(m[3][0], det2_01_23, m[3][2], det2_01_03, m[3][3], det2_01_02);
+		vfloat det3_301_123 = DET3(m[3][1], det2_01_23, m[3][2], det2_01_13, m[3][3], det2_01_12);
+
+		vfloat neginvdet = VF_SUB(VF_ZERO(), invdet);
+
+		r[0][0] = VF_MUL(det3_213_123, neginvdet);
+		r[1][0] = VF_MUL(det3_213_023, invdet);
+		r[2][0] = VF_MUL(det3_213_013, neginvdet);
+		r[3][0] = VF_MUL(det3_213_012, invdet);
+
+		r[0][1] = VF_MUL(det3_203_123, invdet);
+		r[1][1] = VF_MUL(det3_203_023, neginvdet);
+		r[2][1] = VF_MUL(det3_203_013, invdet);
+		r[3][1] = VF_MUL(det3_203_012, neginvdet);
+
+		r[0][2] = VF_MUL(det3_301_123, invdet);
+		r[1][2] = VF_MUL(det3_301_023, neginvdet);
+		r[2][2] = VF_MUL(det3_301_013, invdet);
+		r[3][2] = VF_MUL(det3_301_012, neginvdet);
+
+		r[0][3] = VF_MUL(det3_201_123, neginvdet);
+		r[1][3] = VF_MUL(det3_201_023, invdet);
+		r[2][3] = VF_MUL(det3_201_013, neginvdet);
+		r[3][3] = VF_MUL(det3_201_012, invdet);
+
+		// singular lanes pass their input through unchanged
+		for(int e = 0; e < 16; e++)
+			VF_STOREU(packet + (e * SIMD_WIDTH), VF_SELECT(bad, m[e >> 2][e & 3], r[e >> 2][e & 3]));
+
+		for(int k = 0; k < SIMD_WIDTH; k++)
+		{
+			float *f = out[i + k].Ptr();
+
+			for(int e = 0; e < 16; e++)
+				f[e] = packet[(e * SIMD_WIDTH) + k];
+		}
+
+		// callers keep start a multiple of 32, so a packet never straddles
+		// two mask words
+		unsigned int bits = (unsigned int)VM_BITS(bad) & ((1u << SIMD_WIDTH) - 1);
+		singular[i >> 5] |= bits << (i & 31);
+	}
+
+	return i;
+}
+
+// the upper 3x3 of matrices instride floats apart, as in mat3x3::InvertTranspose.
+// where that refuses a determinant under MATRIX_INVERSE_RELATIVE_EPSILON times
+// the row lengths this writes the cofactor matrix instead
+static int SIMD_FN(MatrixBatch_NormalKernel)(mat3x3 *out, const float *in, int instride, int start, int end)
+{
+	int	i;
+	float	packet[9 * SIMD_WIDTH];
+	vfloat	m[3][3];
+	vfloat	c[3][3];
+
+	vfloat one = VF_SET1(1.0f);
+	vfloat epsilon = VF_SET1(MATRIX_INVERSE_RELATIVE_EPSILON);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		for(int k = 0; k < SIMD_WIDTH; k++)
+		{
+			const float *f = in + ((size_t)(i + k) * instride);
+
+			for(int e = 0; e < 9; e++)
+				packet[(e * SIMD_WIDTH) + k] = f[((e / 3) * 4) + (e % 3)];
+		}
+
+		for(int e = 0; e < 9; e++)
+			m[e / 3][e % 3] = VF_LOADU(packet + (e * SIMD_WIDTH));
+
+		// each cofactor row is the cross product of the other two rows
+		c[0][0] = DET2(m[1][1], m[2][2], m[1][2], m[2][1]);
+		c[0][1] = DET2(m[1][2], m[2][0], m[1][0], m[2][2]);
+		c[0][2] = DET2(m[1][0], m[2][1], m[1][1], m[2][0]);
+
+		c[1][0] = DET2(m[0][2], m[2][1], m[0][1], m[2][2]);
+		c[1][1] = DET2(m[0][0], m[2][2], m[0][2], m[2][0]);
+		c[1][2] = DET2(m[0][1], m[2][0], m[0][0], m[2][1]);
+
+		c[2][0] = DET2(m[0][1], m[1][2], m[0][2], m[1][1]);
+		c[2][1] = DET2(m[0][2], m[1][0], m[0][0], m[1][2]);
+		c[2][2] = DET2(m[0][0], m[1][1], m[0][1], m[1][0]);
+
+		vfloat det = VF_FMADD(m[0][2], c[0][2], VF_FMADD(m[0][1], c[0][1], VF_MUL(m[0][0], c[0][0])));
+		vfloat rows = epsilon;
+		for(int r = 0; r < 3; r++)
+			rows = VF_MUL(rows, VF_SQRT(VF_FMADD(m[r][2], m[r][2], VF_FMADD(m[r][1], m[r][1], VF_MUL(m[r][0], m[r][0])))));
+
+		vmask bad = VF_CMPLE(VF_ABS(det), rows);
+		vfloat invdet = VF_DIV(one, VF_SELECT(bad, one, det));
+
+		for(int e = 0; e < 9; e++)
+			VF_STOREU(packet + (e * SIMD_WIDTH), VF_MUL(c[e / 3][e % 3], invdet));
+
+		for(int k = 0; k < SIMD_WIDTH; k++)
+		{
+			float *f = out[i + k].Ptr();
+
+			for(int e = 0; e < 9; e++)
+				f[e] = packet[(e * SIMD_WIDTH) + k];
+		}
+	}
+
+	return i;
+}
+
+#undef DET2
+#undef DET3
@@ -0,0 +1,167 @@
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "parallel.h"
+
+typedef struct parallel_pool_s
+{
+	std::mutex			lock;
+	std::condition_variable		wake;
+	std::condition_variable		done;
+	std::vector<std::thread>	threads;
+	bool				started;
+	bool				quit;
+
+	// the current job
+	unsigned int			generation;
+	int				active;
+	parallel_func_t			func;
+	void				*context;
+	int				count;
+	int				grainsize;
+	std::atomic<int>		next;
+
+	~parallel_pool_s();
+
+} parallel_pool_t;
+
+static parallel_pool_t	pool;
+static std::mutex	parallel_submitlock;
+static int		parallel_numthreads = 0;
+
+static thread_local bool parallel_inchunk = false;
+
+static void Parallel_RunChunks()
+{
+	parallel_inchunk = true;
+
+	for(;;)
+	{
+		int start = pool.next.fetch_add(pool.grainsize);
+		if(start >= pool.count)
+			break;
+
+		int end = start + pool.grainsize;
+		if(end > pool.count)
+			end = pool.count;
+
+		pool.func(pool.context, start, end);
+	}
+
+	parallel_inchunk = false;
+}
+
+// workers start before the first job is posted, so they begin at
+// generation zero even if the submitter has already moved past it
+static void Parallel_Worker()
+{
+	std::unique_lock<std::mutex> l(pool.lock);
+	unsigned int seen = 0;
+
+	for(;;)
+	{
+		pool.wake.wait(l, [&] { return pool.quit || pool.generation != seen; });
+		if(pool.quit)
+			return;
+
+		seen = pool.generation;
+
+		l.unlock();
+		Parallel_RunChunks();
+		l.lock();
+
+		if(--pool.active == 0)
+			pool.done.notify_all();
+	}
+}
+
+parallel_pool_s::~parallel_pool_s()
+{
+	{
+		std::lock_guard<std::mutex> l(lock);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for(size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+}
+
+static void Parallel_Start()
+{
+	if(parallel_numthreads <= 0)
+	{
+		parallel_numthreads = (int)std::thread::hardware_concurrency();
+		if(parallel_numthreads <= 0)
+			parallel_numthreads = 1;
+	}
+
+	pool.generation	= 0;
+	pool.active	= 0;
+
+	for(int i = 0; i < parallel_numthreads - 1; i++)
+		pool.threads.push_back(std::thread(Parallel_Worker));
+
+	pool.started = true;
+}
+
+void Parallel_SetNumThreads(int numthreads)
+{
+	std::lock_guard<std::mutex> s(parallel_submitlock);
+
+	if(!pool.started)
+		parallel_numthreads = numthreads;
+}
+
+int Parallel_NumThreads()
+{
+	std::lock_guard<std::mutex> s(parallel_submitlock);
+
+	if(!pool.started)
+		Parallel_Start();
+
+	return parallel_numthreads;
+}
+
+void Parallel_For(int count, int grainsize, parallel_func_t func, void *context)
+{
+	if(grainsize < 1)
+		grainsize = 1;
+
+	if(count <= grainsize || parallel_inchunk)
+	{
+		func(context, 0, count);
+		return;
+	}
+
+	std::lock_guard<std::mutex> s(parallel_submitlock);
+
+	if(!pool.started)
+		Parallel_Start();
+
+	if(pool.threads.empty())
+	{
+		func(context, 0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> l(pool.lock);
+
+		pool.func	= func;
+		pool.context	= context;
+		pool.count	= count;
+		pool.grainsize	= grainsize;
+		pool.next	= 0;
+		pool.active	= (int)pool.threads.size();
+		pool.generation++;
+	}
+	pool.wake.notify_all();
+
+	Parallel_RunChunks();
+
+	std::unique_lock<std::mutex> l(pool.lock);
+	pool.done.wait(l, [] { return pool.active == 0; });
+}
@@ -0,0 +1,20 @@
+/*=============================================================================
+	parallel.h
+============================================================================*/
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+// work on the index range [start, end)
+typedef void (*parallel_func_t)(void *context, int start, int end);
+
+// split [0, count) into chunks of grainsize and run them on the worker pool,
+// returning when every chunk is done. the calling thread takes chunks too.
+// small ranges and calls made from inside a chunk run serially
+void Parallel_For(int count, int grainsize, parallel_func_t func, void *context);
+
+// workers plus the calling thread. must be set before the first Parallel_For
+void Parallel_SetNumThreads(int numthreads);
+int Parallel_NumThreads();
+
+#endif
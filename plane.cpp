@@ -1,24 +1,90 @@
+#include <string.h>
 #include "vector.h"
 #include "plane.h"
+#include "vec3soa.h"
+
+static inline int Plane_CountBits(unsigned int bits)
+{
+	int count = 0;
+
+	for(; bits; bits &= bits - 1)
+		count++;
+
+	return count;
+}
+
+// move bit k of a 16 bit mask to bit 2k
+static inline unsigned int Plane_SpreadBits(unsigned int bits)
+{
+	bits = (bits | (bits << 8)) & 0x00ff00ff;
+	bits = (bits | (bits << 4)) & 0x0f0f0f0f;
+	bits = (bits | (bits << 2)) & 0x33333333;
+	bits = (bits | (bits << 1)) & 0x55555555;
+
+	return bits;
+}
+
+#define SIMD_KERNELS "plane_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(Plane_ClassifyKernel);
+
+// vertices deinterleaved per pass, a multiple of 16 to keep the side codes
+// of each pass on word boundaries
+#define PLANE_CLASSIFY_BLOCK	256
 
 plane_t::plane_t()
+	: type(PLANE_NONAXIAL), signbits(0)
 {}
 
 plane_t::plane_t(float a, float b, float c, float d)
 	: a(a), b(b), c(c), d(d)
-{}
+{
+	SetType();
+}
 
 plane_t::plane_t(vec3 n, float d)
 {
 	a = n.x;
 	b = n.y;
 	c = n.z;
-	d = -d;
+	this->d = -d;
+
+	SetType();
+}
+
+void plane_t::SetType()
+{
+	type = (unsigned char)Plane_TypeForNormal(a, b, c);
+	signbits = (unsigned char)(((a < 0.0f) ? 1 : 0) | ((b < 0.0f) ? 2 : 0) | ((c < 0.0f) ? 4 : 0));
 }
 
 void plane_t::Reverse()
 {
-	plane_t(-a, -b, -c, -d);
+	a = -a;
+	b = -b;
+	c = -c;
+	d = -d;
+
+	SetType();
+}
+
+// scale to a unit normal so Distance is in world units
+void plane_t::Normalize()
+{
+	float length = sqrtf((a * a) + (b * b) + (c * c));
+
+	if(length == 0.0f)
+	{
+		return;
+	}
+
+	float invlength = 1.0f / length;
+
+	a *= invlength;
+	b *= invlength;
+	c *= invlength;
+	d *= invlength;
 }
 
 //void plane_t::PositionThroughPoint(vec3 p)
@@ -47,12 +113,14 @@ float plane_t::Distance()
 
 void plane_t::FromVecs(vec3 s, vec3 t, vec3 p)
 {
-	vec3 n	= Vec3_Cross(s, t);
+	vec3 n	= Cross(s, t);
 
 	a	= n.x;
 	b	= n.y;
 	c	= n.z;
-	d	= -Vec3_Dot(n, p);
+	d	= -Dot(n, p);
+
+	SetType();
 }
 
 void plane_t::FromPoints(vec3 p0, vec3 p1, vec3 p2)
@@ -63,8 +131,14 @@ void plane_t::FromPoints(vec3 p0, vec3 p1, vec3 p2)
 	FromVecs(s, t, p0);
 }
 
+// axial planes only need the one component
 float plane_t::Distance(vec3& p)
 {
+	if(type < PLANE_NONAXIAL)
+	{
+		return ((&a)[type] * p[type]) + d;
+	}
+
 	return (a * p.x) + (b * p.y) + (c * p.z) + d;
 }
 
@@ -85,6 +159,52 @@ int plane_t::Side(vec3& p, const float epsilon)
 	return PLANE_SIDE_ON;
 }
 
+// PLANE_SIDE_FRONT or PLANE_SIDE_BACK when the box is entirely on one side,
+// PLANE_SIDE_CROSS when it straddles the plane
+int plane_t::BoxOnPlaneSide(const vec3& bmin, const vec3& bmax)
+{
+	float nearest, farthest;
+
+	if(type < PLANE_NONAXIAL)
+	{
+		float n = (&a)[type];
+
+		nearest		= (n * ((n < 0.0f) ? bmax[type] : bmin[type])) + d;
+		farthest	= (n * ((n < 0.0f) ? bmin[type] : bmax[type])) + d;
+	}
+	else
+	{
+		// the sign bits pick the corners nearest and farthest along the normal
+		const vec3 *corners[2] = { &bmin, &bmax };
+
+		nearest = d;
+		farthest = d;
+
+		for(int i = 0; i < 3; i++)
+		{
+			int negative = (signbits >> i) & 1;
+			float n = (&a)[i];
+
+			nearest += n * (*corners[negative])[i];
+			farthest += n * (*corners[negative ^ 1])[i];
+		}
+	}
+
+	int sides = 0;
+
+	if(farthest >= 0.0f)
+	{
+		sides |= PLANE_SIDE_FRONT;
+	}
+
+	if(nearest < 0.0f)
+	{
+		sides |= PLANE_SIDE_BACK;
+	}
+
+	return sides;
+}
+
 bool plane_t::PlaneLineIntersection(vec3 start, vec3 end, vec3 *hitpoint)
 {
 	float d1, d2;
@@ -112,7 +232,7 @@ bool plane_t::PlaneLineIntersection(vec3 start, vec3 end, vec3 *hitpoint)
 		float fraction;
 		fraction = (d1 / (d1 - d2));
 
-		*hitpoint = start + fraction * (start - end);
+		*hitpoint = start + fraction * (end - start);
 		return true;
 	}
 
@@ -141,20 +261,48 @@ bool plane_t::PlaneLineIntersection(vec3 start, vec3 end, vec3 *hitpoint)
 #endif
 }
 
+// start + fraction * dir is on the plane. rays parallel to the plane or
+// pointing away from it miss
 bool plane_t::RayIntersection(vec3 start, vec3 dir, float* fraction)
 {
-#if 0	
 	float d1, d2;
 
-	d1 = normal.Dot(start) + dist;
-	d2 = normal.Dot(dir);
+	d1 = Distance(start);
+	d2 = (a * dir.x) + (b * dir.y) + (c * dir.z);
+
 	if(d2 == 0.0f)
-		return f alse;
+	{
+		return false;
+	}
+
+	float f = -(d1 / d2);
+	if(f < 0.0f)
+	{
+		return false;
+	}
+
+	*fraction = f;
+	return true;
+}
+
+int Plane_TypeForNormal(float a, float b, float c)
+{
+	if(b == 0.0f && c == 0.0f)
+	{
+		return PLANE_X;
+	}
+
+	if(a == 0.0f && c == 0.0f)
+	{
+		return PLANE_Y;
+	}
+
+	if(a == 0.0f && b == 0.0f)
+	{
+		return PLANE_Z;
+	}
 
-	*fraction = -(d1 / d2);
-	return 1;
-#endif	
-	return false;
+	return PLANE_NONAXIAL;
 }
 
 plane_t plane_t::operator-()
@@ -165,3 +313,57 @@ plane_t plane_t::operator-()
 	return r;
 }
 
+
+/*-----------------------------------------------------------------------------
+	batch classification
+-----------------------------------------------------------------------------*/
+
+static void Plane_BeginClassify(int numpoints, unsigned int *sides, int counts[3])
+{
+	memset(sides, 0, PLANE_SIDE_WORDS(numpoints) * sizeof(unsigned int));
+
+	counts[PLANE_SIDE_ON]		= 0;
+	counts[PLANE_SIDE_BACK]		= 0;
+	counts[PLANE_SIDE_FRONT]	= 0;
+}
+
+static void Plane_ClassifyPlanes(const plane_t& p, const float *x, const float *y, const float *z, float epsilon, float *dists, unsigned int *sides, int *counts, int numpoints)
+{
+	int i = SIMD_CALL(Plane_ClassifyKernel)(x, y, z, &p, epsilon, dists, sides, counts, 0, numpoints);
+	Plane_ClassifyKernel_scalar(x, y, z, &p, epsilon, dists, sides, counts, i, numpoints);
+}
+
+void Plane_ClassifyPoints(const plane_t& p, const vec3 *points, int numpoints, float epsilon, float *dists, unsigned int *sides, int counts[3])
+{
+	float	x[PLANE_CLASSIFY_BLOCK];
+	float	y[PLANE_CLASSIFY_BLOCK];
+	float	z[PLANE_CLASSIFY_BLOCK];
+
+	Plane_BeginClassify(numpoints, sides, counts);
+
+	for(int start = 0; start < numpoints; start += PLANE_CLASSIFY_BLOCK)
+	{
+		int count = numpoints - start;
+		if(count > PLANE_CLASSIFY_BLOCK)
+			count = PLANE_CLASSIFY_BLOCK;
+
+		for(int i = 0; i < count; i++)
+		{
+			x[i] = points[start + i].x;
+			y[i] = points[start + i].y;
+			z[i] = points[start + i].z;
+		}
+
+		Plane_ClassifyPlanes(p, x, y, z, epsilon, dists + start, sides + (start >> 4), counts, count);
+	}
+
+	counts[PLANE_SIDE_ON] = numpoints - counts[PLANE_SIDE_FRONT] - counts[PLANE_SIDE_BACK];
+}
+
+void Plane_ClassifySoA(const plane_t& p, const vec3_soa *points, float epsilon, float *dists, unsigned int *sides, int counts[3])
+{
+	Plane_BeginClassify(points->numvectors, sides, counts);
+	Plane_ClassifyPlanes(p, points->x, points->y, points->z, epsilon, dists, sides, counts, points->numvectors);
+
+	counts[PLANE_SIDE_ON] = points->numvectors - counts[PLANE_SIDE_FRONT] - counts[PLANE_SIDE_BACK];
+}
@@ -4,10 +4,22 @@
 #define PLANE_SIDE_ON		0
 #define PLANE_SIDE_BACK		1
 #define PLANE_SIDE_FRONT	2
+#define PLANE_SIDE_CROSS	3	// BoxOnPlaneSide only, front and back
 
 #define PLANE_DEFAULT_EPSILON	(0.1f)
 
+// axial type of a plane, PLANE_X to PLANE_Z match the normal component
+#define PLANE_X			0
+#define PLANE_Y			1
+#define PLANE_Z			2
+#define PLANE_NONAXIAL		3
+
+// packed 2 bit side codes, 16 per word
+#define PLANE_SIDE_WORDS(n)		(((n) + 15) >> 4)
+#define PLANE_SIDE_GET(sides, i)	(((sides)[(i) >> 4] >> (((i) & 15) * 2)) & 3)
+
 class vec3;
+typedef struct vec3_soa_s vec3_soa;
 
 class plane_t
 {
@@ -17,11 +29,19 @@ public:
 	float	c;
 	float	d;
 
+	// derived from a, b and c by the constructors and the functions below,
+	// call SetType after writing them directly
+	unsigned char	type;		// PLANE_X to PLANE_NONAXIAL
+	unsigned char	signbits;	// bit i set when normal component i is negative
+	unsigned char	pad[2];
+
 	plane_t();
 	plane_t(float a, float b, float c, float d);
 	plane_t(vec3 n, float d);
 
+	void SetType();
 	void Reverse();
+	void Normalize();
 	void PositionThroughPoint(vec3 p);
 	//void SetNormal(vec3 n);
 	//void SetDistance(float d);
@@ -33,10 +53,20 @@ public:
 
 	float Distance(vec3& p);
 	int Side(vec3& p, const float epsilon = 0.1f);
+	int BoxOnPlaneSide(const vec3& bmin, const vec3& bmax);
 	bool PlaneLineIntersection(vec3 start, vec3 end, vec3 *hitpoint);
 	bool RayIntersection(vec3 start, vec3 dir, float* fraction);
 
 	plane_t operator-();
 };
 
+// PLANE_X, Y or Z when the normal lies exactly on that axis
+int Plane_TypeForNormal(float a, float b, float c);
+
+// Distance and Side for a whole vertex array in one pass. dists gets one
+// float per point, sides PLANE_SIDE_WORDS(numpoints) words of codes read with
+// PLANE_SIDE_GET, and counts[PLANE_SIDE_*] the number of points on each side
+void Plane_ClassifyPoints(const plane_t& p, const vec3 *points, int numpoints, float epsilon, float *dists, unsigned int *sides, int counts[3]);
+void Plane_ClassifySoA(const plane_t& p, const vec3_soa *points, float epsilon, float *dists, unsigned int *sides, int counts[3]);
+
 #endif
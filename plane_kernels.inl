@@ -0,0 +1,39 @@
+/*=============================================================================
+	plane_kernels.inl
+
+	per-tier plane classification, see simd_variants.h. the side codes of a
+	packet are built from the front and back compare masks by spreading
+	each mask to every other bit, so packets must start on a multiple of 16
+-----------------------------------------------------------------------------*/
+
+static int SIMD_FN(Plane_ClassifyKernel)(const float *x, const float *y, const float *z, const plane_t *p, float epsilon, float *dists, unsigned int *sides, int *counts, int start, int end)
+{
+	int i;
+
+	vfloat a = VF_SET1(p->a);
+	vfloat b = VF_SET1(p->b);
+	vfloat c = VF_SET1(p->c);
+	vfloat d = VF_SET1(p->d);
+	vfloat front = VF_SET1(epsilon);
+	vfloat back = VF_SET1(-epsilon);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat dist = VF_FMADD(a, VF_LOADU(x + i), d);
+		dist = VF_FMADD(b, VF_LOADU(y + i), dist);
+		dist = VF_FMADD(c, VF_LOADU(z + i), dist);
+
+		VF_STOREU(dists + i, dist);
+
+		unsigned int f = (unsigned int)VM_BITS(VF_CMPGT(dist, front));
+		unsigned int k = (unsigned int)VM_BITS(VF_CMPLT(dist, back));
+
+		counts[PLANE_SIDE_FRONT] += Plane_CountBits(f);
+		counts[PLANE_SIDE_BACK] += Plane_CountBits(k);
+
+		unsigned int codes = (Plane_SpreadBits(f) * PLANE_SIDE_FRONT) | (Plane_SpreadBits(k) * PLANE_SIDE_BACK);
+		sides[i >> 4] |= codes << ((i & 15) * 2);
+	}
+
+	return i;
+}
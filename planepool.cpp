@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include "planepool.h"
+#include "simd.h"
+
+/*-----------------------------------------------------------------------------
+	allocation
+-----------------------------------------------------------------------------*/
+
+planepool_t *PlanePool_Alloc(int maxplanes)
+{
+	planepool_t	*pool;
+
+	// pairs only
+	maxplanes &= ~1;
+
+	int headerbytes = (sizeof(planepool_t) + SIMD_ALIGN - 1) & ~(SIMD_ALIGN - 1);
+	int numbytes = headerbytes + (maxplanes * (sizeof(plane_t) + sizeof(int)));
+	pool = (planepool_t*)Simd_AlignedAlloc(numbytes);
+	if(!pool)
+		return NULL;
+
+	char *p = (char*)pool + headerbytes;
+
+	pool->maxplanes		= maxplanes;
+	pool->normalepsilon	= PLANEPOOL_NORMAL_EPSILON;
+	pool->distepsilon	= PLANEPOOL_DIST_EPSILON;
+	pool->planes		= (plane_t*)p;
+	pool->hashchain		= (int*)(p + (maxplanes * sizeof(plane_t)));
+
+	PlanePool_Clear(pool);
+
+	return pool;
+}
+
+void PlanePool_Free(planepool_t *pool)
+{
+	Simd_AlignedFree(pool);
+}
+
+void PlanePool_Clear(planepool_t *pool)
+{
+	pool->numplanes = 0;
+
+	for(int i = 0; i < PLANEPOOL_HASH_SIZE; i++)
+		pool->hashtable[i] = -1;
+}
+
+/*-----------------------------------------------------------------------------
+	lookup
+-----------------------------------------------------------------------------*/
+
+// the distance is wrapped before converting, which is undefined past
+// INT_MAX. wrapping keeps near distances in neighbouring buckets, and an
+// infinite or nan distance lands in the first
+static int PlanePool_Hash(float d)
+{
+	float f = fmodf(fabsf(d), (float)PLANEPOOL_HASH_SIZE);
+
+	if(!(f >= 0.0f))
+		return 0;
+
+	return (int)f;
+}
+
+// pull normals within epsilon of an axis onto it, and distances within
+// epsilon of a whole number onto it
+static plane_t PlanePool_Snap(const planepool_t *pool, const plane_t& p)
+{
+	plane_t	r = p;
+	float	*n[3] = { &r.a, &r.b, &r.c };
+
+	for(int i = 0; i < 3; i++)
+	{
+		if(fabs(*n[i] - 1.0f) < pool->normalepsilon || fabs(*n[i] + 1.0f) < pool->normalepsilon)
+		{
+			float s = (*n[i] > 0.0f) ? 1.0f : -1.0f;
+
+			r.a = r.b = r.c = 0.0f;
+			*n[i] = s;
+			break;
+		}
+	}
+
+	float rounded = floorf(r.d + 0.5f);
+	if(fabs(r.d - rounded) < pool->distepsilon)
+	{
+		r.d = rounded;
+	}
+
+	r.SetType();
+
+	return r;
+}
+
+static bool PlanePool_Equal(const planepool_t *pool, const plane_t& a, const plane_t& b)
+{
+	return	fabs(a.a - b.a) < pool->normalepsilon &&
+		fabs(a.b - b.b) < pool->normalepsilon &&
+		fabs(a.c - b.c) < pool->normalepsilon &&
+		fabs(a.d - b.d) < pool->distepsilon;
+}
+
+static void PlanePool_Link(planepool_t *pool, int index)
+{
+	int h = PlanePool_Hash(pool->planes[index].d);
+
+	pool->hashchain[index] = pool->hashtable[h];
+	pool->hashtable[h] = index;
+}
+
+// the even slot gets the plane whose first nonzero normal component is
+// positive, so axial planes face along their axis
+static bool PlanePool_IsPositive(const plane_t& p)
+{
+	if(p.a != 0.0f)
+	{
+		return p.a > 0.0f;
+	}
+
+	if(p.b != 0.0f)
+	{
+		return p.b > 0.0f;
+	}
+
+	return p.c > 0.0f;
+}
+
+int PlanePool_FindPlane(planepool_t *pool, const plane_t& p)
+{
+	plane_t s = PlanePool_Snap(pool, p);
+
+	// a distance near a bucket edge may have been stored in the neighbour
+	int h = PlanePool_Hash(s.d);
+
+	for(int i = -1; i <= 1; i++)
+	{
+		int bucket = (h + i) & (PLANEPOOL_HASH_SIZE - 1);
+
+		for(int j = pool->hashtable[bucket]; j >= 0; j = pool->hashchain[j])
+		{
+			if(PlanePool_Equal(pool, pool->planes[j], s))
+			{
+				return j;
+			}
+		}
+	}
+
+	if(pool->numplanes + 2 > pool->maxplanes)
+	{
+		return -1;
+	}
+
+	int index = pool->numplanes;
+	plane_t r = -s;
+
+	bool positive = PlanePool_IsPositive(s);
+
+	pool->planes[index]	= positive ? s : r;
+	pool->planes[index + 1]	= positive ? r : s;
+
+	PlanePool_Link(pool, index);
+	PlanePool_Link(pool, index + 1);
+
+	pool->numplanes += 2;
+
+	return positive ? index : index + 1;
+}
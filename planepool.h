@@ -0,0 +1,61 @@
+/*=============================================================================
+	planepool.h
+============================================================================*/
+
+#ifndef __PLANEPOOL_H__
+#define __PLANEPOOL_H__
+
+#include "vector.h"
+#include "plane.h"
+
+#define PLANEPOOL_HASH_SIZE		1024
+#define PLANEPOOL_NORMAL_EPSILON	(0.00001f)
+#define PLANEPOOL_DIST_EPSILON		(0.01f)
+
+// planes are stored in opposite facing pairs
+#define PLANEPOOL_OPPOSITE(i)		((i) ^ 1)
+
+/*-----------------------------------------------------------------------------
+	planepool_t
+
+	deduplicated set of unit length planes addressed by index. a new plane
+	is stored next to its reverse, the one facing along the positive axis
+	at the even index, so flipping a plane is index ^ 1. planes are hashed
+	on the magnitude of d and compared within the pool epsilons
+-----------------------------------------------------------------------------*/
+
+typedef struct planepool_s
+{
+	int		maxplanes;
+	int		numplanes;
+
+	float		normalepsilon;
+	float		distepsilon;
+
+	plane_t		*planes;
+
+	int		*hashchain;	// next plane in the same bucket, -1 ends
+	int		hashtable[PLANEPOOL_HASH_SIZE];
+
+} planepool_t;
+
+planepool_t *PlanePool_Alloc(int maxplanes);
+void PlanePool_Free(planepool_t *pool);
+void PlanePool_Clear(planepool_t *pool);
+
+// index of the pooled plane matching p, adding it and its reverse if there
+// is none. near axial normals and near integer distances are snapped first.
+// returns -1 when the pool is full
+int PlanePool_FindPlane(planepool_t *pool, const plane_t& p);
+
+inline const plane_t& PlanePool_Plane(const planepool_t *pool, int index)
+{
+	return pool->planes[index];
+}
+
+inline int PlanePool_Type(const planepool_t *pool, int index)
+{
+	return pool->planes[index].type;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#include <assert.h>
+#include <string.h>
+#include "planeset.h"
+
+#define PLANESET_HUGE		(1e20f)
+
+#define SIMD_KERNELS "planeset_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(PlaneSet_PointKernel);
+SIMD_DISPATCH(PlaneSet_BoxKernel);
+SIMD_DISPATCH(PlaneSet_PointsKernel);
+
+// points deinterleaved per pass, a multiple of 32 to keep each pass on
+// mask word boundaries
+#define PLANESET_BLOCK		256
+
+static int PlaneSet_Capacity(int maxplanes)
+{
+	return (maxplanes + VEC3SOA_GRANULARITY - 1) & ~(VEC3SOA_GRANULARITY - 1);
+}
+
+static int PlaneSet_CountBits(const unsigned int *bits, int numwords)
+{
+	int count = 0;
+
+	for(int i = 0; i < numwords; i++)
+	{
+		for(unsigned int w = bits[i]; w; w &= w - 1)
+			count++;
+	}
+
+	return count;
+}
+
+/*-----------------------------------------------------------------------------
+	plane_set
+-----------------------------------------------------------------------------*/
+
+plane_set *PlaneSet_Alloc(int maxplanes)
+{
+	plane_set	*s;
+
+	// header in the first alignment block, then a, b, c and d
+	int capacity = PlaneSet_Capacity(maxplanes);
+	int numbytes = SIMD_ALIGN + (4 * capacity * sizeof(float));
+	s = (plane_set*)Simd_AlignedAlloc(numbytes);
+	if(!s)
+		return NULL;
+
+	float *base = (float*)((char*)s + SIMD_ALIGN);
+
+	s->maxplanes	= maxplanes;
+	s->a		= base;
+	s->b		= base + capacity;
+	s->c		= base + (2 * capacity);
+	s->d		= base + (3 * capacity);
+
+	PlaneSet_Clear(s);
+
+	return s;
+}
+
+void PlaneSet_Free(plane_set *s)
+{
+	Simd_AlignedFree(s);
+}
+
+void PlaneSet_Clear(plane_set *s)
+{
+	int capacity = PlaneSet_Capacity(s->maxplanes);
+
+	for(int i = 0; i < capacity; i++)
+	{
+		s->a[i] = 0.0f;
+		s->b[i] = 0.0f;
+		s->c[i] = 0.0f;
+		s->d[i] = PLANESET_HUGE;
+	}
+
+	s->numplanes = 0;
+}
+
+void PlaneSet_Add(plane_set *s, const plane_t& p)
+{
+	assert(s->numplanes < s->maxplanes);
+
+	int i = s->numplanes++;
+
+	s->a[i] = p.a;
+	s->b[i] = p.b;
+	s->c[i] = p.c;
+	s->d[i] = p.d;
+}
+
+void PlaneSet_FromPlanes(plane_set *s, const plane_t *planes, int numplanes)
+{
+	PlaneSet_Clear(s);
+
+	for(int i = 0; i < numplanes; i++)
+		PlaneSet_Add(s, planes[i]);
+}
+
+/*-----------------------------------------------------------------------------
+	single queries
+-----------------------------------------------------------------------------*/
+
+float PlaneSet_MinDistance(const plane_set *s, const vec3& p)
+{
+	float	mindist = PLANESET_HUGE;
+	int	end = PlaneSet_Capacity(s->numplanes);
+
+	int i = SIMD_CALL(PlaneSet_PointKernel)(s, &p, &mindist, 0, end);
+	PlaneSet_PointKernel_scalar(s, &p, &mindist, i, end);
+
+	return mindist;
+}
+
+bool PlaneSet_ContainsPoint(const plane_set *s, const vec3& p, float epsilon)
+{
+	return PlaneSet_MinDistance(s, p) >= -epsilon;
+}
+
+int PlaneSet_ClassifySphere(const plane_set *s, const vec3& center, float radius)
+{
+	float d = PlaneSet_MinDistance(s, center);
+
+	if(d < -radius)
+	{
+		return PLANESET_OUTSIDE;
+	}
+
+	if(d >= radius)
+	{
+		return PLANESET_INSIDE;
+	}
+
+	return PLANESET_INTERSECT;
+}
+
+// a box that straddles two planes outside a corner of the volume is
+// reported as intersecting, the same conservative answer as the frustum cull
+int PlaneSet_ClassifyBox(const plane_set *s, const vec3& bmin, const vec3& bmax)
+{
+	vec3	center = 0.5f * (bmin + bmax);
+	vec3	extent = 0.5f * (bmax - bmin);
+	float	minnear = PLANESET_HUGE;
+	float	minfar = PLANESET_HUGE;
+	int	end = PlaneSet_Capacity(s->numplanes);
+
+	int i = SIMD_CALL(PlaneSet_BoxKernel)(s, &center, &extent, &minnear, &minfar, 0, end);
+	PlaneSet_BoxKernel_scalar(s, &center, &extent, &minnear, &minfar, i, end);
+
+	if(minfar < 0.0f)
+	{
+		return PLANESET_OUTSIDE;
+	}
+
+	if(minnear >= 0.0f)
+	{
+		return PLANESET_INSIDE;
+	}
+
+	return PLANESET_INTERSECT;
+}
+
+/*-----------------------------------------------------------------------------
+	batch queries
+-----------------------------------------------------------------------------*/
+
+static void PlaneSet_ContainsPlanes(const plane_set *s, const float *x, const float *y, const float *z, float epsilon, unsigned int *inside, int numpoints)
+{
+	int i = SIMD_CALL(PlaneSet_PointsKernel)(s, x, y, z, epsilon, inside, 0, numpoints);
+	PlaneSet_PointsKernel_scalar(s, x, y, z, epsilon, inside, i, numpoints);
+}
+
+int PlaneSet_ContainsPoints(const plane_set *s, const vec3 *points, int numpoints, float epsilon, unsigned int *inside)
+{
+	float	x[PLANESET_BLOCK];
+	float	y[PLANESET_BLOCK];
+	float	z[PLANESET_BLOCK];
+
+	memset(inside, 0, PLANESET_MASKWORDS(numpoints) * sizeof(unsigned int));
+
+	for(int start = 0; start < numpoints; start += PLANESET_BLOCK)
+	{
+		int count = numpoints - start;
+		if(count > PLANESET_BLOCK)
+			count = PLANESET_BLOCK;
+
+		for(int i = 0; i < count; i++)
+		{
+			x[i] = points[start + i].x;
+			y[i] = points[start + i].y;
+			z[i] = points[start + i].z;
+		}
+
+		PlaneSet_ContainsPlanes(s, x, y, z, epsilon, inside + (start >> 5), count);
+	}
+
+	return PlaneSet_CountBits(inside, PLANESET_MASKWORDS(numpoints));
+}
+
+int PlaneSet_ContainsSoA(const plane_set *s, const vec3_soa *points, float epsilon, unsigned int *inside)
+{
+	memset(inside, 0, PLANESET_MASKWORDS(points->numvectors) * sizeof(unsigned int));
+
+	PlaneSet_ContainsPlanes(s, points->x, points->y, points->z, epsilon, inside, points->numvectors);
+
+	return PlaneSet_CountBits(inside, PLANESET_MASKWORDS(points->numvectors));
+}
@@ -0,0 +1,59 @@
+/*=============================================================================
+	planeset.h
+============================================================================*/
+
+#ifndef __PLANESET_H__
+#define __PLANESET_H__
+
+#include "vector.h"
+#include "plane.h"
+#include "vec3soa.h"
+
+// ClassifySphere and ClassifyBox results
+#define PLANESET_OUTSIDE	0
+#define PLANESET_INSIDE		1
+#define PLANESET_INTERSECT	2
+
+// words needed for a per-point bitmask
+#define PLANESET_MASKWORDS(n)	(((n) + 31) >> 5)
+
+/*-----------------------------------------------------------------------------
+	plane_set
+
+	convex volume bounded by a set of planes with a, b, c and d from plane_t
+	in separate aligned arrays. the volume is on the front side of every
+	plane, as in frustum_t, so brush planes that face out need a Reverse.
+	unused slots up to the allocated capacity hold planes that everything is
+	in front of, so the kernels never need a remainder loop over the planes
+-----------------------------------------------------------------------------*/
+
+typedef struct plane_set_s
+{
+	int	maxplanes;
+	int	numplanes;
+	float	*a;
+	float	*b;
+	float	*c;
+	float	*d;
+
+} plane_set;
+
+plane_set *PlaneSet_Alloc(int maxplanes);
+void PlaneSet_Free(plane_set *s);
+void PlaneSet_Clear(plane_set *s);
+void PlaneSet_Add(plane_set *s, const plane_t& p);
+void PlaneSet_FromPlanes(plane_set *s, const plane_t *planes, int numplanes);
+
+// the smallest plane distance of a point, negative when it is outside
+float PlaneSet_MinDistance(const plane_set *s, const vec3& p);
+
+bool PlaneSet_ContainsPoint(const plane_set *s, const vec3& p, float epsilon);
+int PlaneSet_ClassifySphere(const plane_set *s, const vec3& center, float radius);
+int PlaneSet_ClassifyBox(const plane_set *s, const vec3& bmin, const vec3& bmax);
+
+// bit i of inside is set when point i is within epsilon of the volume.
+// inside must hold PLANESET_MASKWORDS(n) words. returns the number inside
+int PlaneSet_ContainsPoints(const plane_set *s, const vec3 *points, int numpoints, float epsilon, unsigned int *inside);
+int PlaneSet_ContainsSoA(const plane_set *s, const vec3_soa *points, float epsilon, unsigned int *inside);
+
+#endif
@@ -0,0 +1,114 @@
+/*=============================================================================
+	planeset_kernels.inl
+
+	per-tier plane set queries, see simd_variants.h. the single object
+	queries run across the planes and fold into the minimum they are given,
+	the batch query runs across the points with the planes broadcast
+-----------------------------------------------------------------------------*/
+
+static float SIMD_FN(PlaneSet_ReduceMin)(vfloat v)
+{
+	float lanes[SIMD_WIDTH];
+	float r;
+
+	VF_STOREU(lanes, v);
+
+	r = lanes[0];
+	for(int k = 1; k < SIMD_WIDTH; k++)
+		r = (lanes[k] < r) ? lanes[k] : r;
+
+	return r;
+}
+
+static int SIMD_FN(PlaneSet_PointKernel)(const plane_set *s, const vec3 *p, float *mindist, int start, int end)
+{
+	int i;
+
+	vfloat x = VF_SET1(p->x);
+	vfloat y = VF_SET1(p->y);
+	vfloat z = VF_SET1(p->z);
+	vfloat m = VF_SET1(*mindist);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat d = VF_FMADD(VF_LOAD(s->a + i), x, VF_LOAD(s->d + i));
+		d = VF_FMADD(VF_LOAD(s->b + i), y, d);
+		d = VF_FMADD(VF_LOAD(s->c + i), z, d);
+
+		m = VF_MIN(m, d);
+	}
+
+	*mindist = SIMD_FN(PlaneSet_ReduceMin)(m);
+
+	return i;
+}
+
+// the corner nearest each plane is center - |n| . extent and the farthest
+// is center + |n| . extent
+static int SIMD_FN(PlaneSet_BoxKernel)(const plane_set *s, const vec3 *center, const vec3 *extent, float *minnear, float *minfar, int start, int end)
+{
+	int i;
+
+	vfloat cx = VF_SET1(center->x);
+	vfloat cy = VF_SET1(center->y);
+	vfloat cz = VF_SET1(center->z);
+	vfloat ex = VF_SET1(extent->x);
+	vfloat ey = VF_SET1(extent->y);
+	vfloat ez = VF_SET1(extent->z);
+	vfloat mn = VF_SET1(*minnear);
+	vfloat mf = VF_SET1(*minfar);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat a = VF_LOAD(s->a + i);
+		vfloat b = VF_LOAD(s->b + i);
+		vfloat c = VF_LOAD(s->c + i);
+
+		vfloat d = VF_FMADD(a, cx, VF_LOAD(s->d + i));
+		d = VF_FMADD(b, cy, d);
+		d = VF_FMADD(c, cz, d);
+
+		vfloat r = VF_MUL(VF_ABS(a), ex);
+		r = VF_FMADD(VF_ABS(b), ey, r);
+		r = VF_FMADD(VF_ABS(c), ez, r);
+
+		mn = VF_MIN(mn, VF_SUB(d, r));
+		mf = VF_MIN(mf, VF_ADD(d, r));
+	}
+
+	*minnear = SIMD_FN(PlaneSet_ReduceMin)(mn);
+	*minfar = SIMD_FN(PlaneSet_ReduceMin)(mf);
+
+	return i;
+}
+
+// packets start on a multiple of SIMD_WIDTH from zero, so the bits of a
+// packet never straddle two mask words
+static int SIMD_FN(PlaneSet_PointsKernel)(const plane_set *s, const float *x, const float *y, const float *z, float epsilon, unsigned int *inside, int start, int end)
+{
+	int i;
+
+	vfloat limit = VF_SET1(-epsilon);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		unsigned int alive = (1u << SIMD_WIDTH) - 1;
+
+		vfloat px = VF_LOADU(x + i);
+		vfloat py = VF_LOADU(y + i);
+		vfloat pz = VF_LOADU(z + i);
+
+		for(int j = 0; j < s->numplanes && alive; j++)
+		{
+			vfloat d = VF_FMADD(VF_SET1(s->a[j]), px, VF_SET1(s->d[j]));
+			d = VF_FMADD(VF_SET1(s->b[j]), py, d);
+			d = VF_FMADD(VF_SET1(s->c[j]), pz, d);
+
+			alive &= ~(unsigned int)VM_BITS(VF_CMPLT(d, limit));
+		}
+
+		inside[i >> 5] |= alive << (i & 31);
+	}
+
+	return i;
+}
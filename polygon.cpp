@@ -1,60 +1,113 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <atomic>
 #include "polygon.h"
+#include "plane.h"
+#include "bounds.h"
 
-// memory allocation
-static void *Polygon_MemAllocHandler(int numbytes)
+// memory allocation. each distinct callback pair gets its own allocator,
+// so a polygon is always freed through the pair it came from. the pairs are
+// a lock free list that is only pushed to and never freed
+typedef struct polygon_callbacks_s
 {
-	return malloc(numbytes);
+	allocator_t			allocator;	// context is this pair
+	void				*(*alloc)(int numbytes);
+	void				(*free)(void *p);
+	struct polygon_callbacks_s	*next;
+
+} polygon_callbacks_t;
+
+static std::atomic<polygon_callbacks_t*>	polygon_callbacks(NULL);
+
+static void *Polygon_CallbackAlloc(void *context, int numbytes)
+{
+	return ((polygon_callbacks_t*)context)->alloc(numbytes);
 }
 
-static void Polygon_MemFreeHandler(void *ptr)
+static void Polygon_CallbackFree(void *context, void *p)
 {
-	free(ptr);
+	((polygon_callbacks_t*)context)->free(p);
 }
 
-static void *(*Polygon_MemAlloc)(int numbytes)	= Polygon_MemAllocHandler;
-static void (*Polygon_MemFree)(void *p)		= Polygon_MemFreeHandler;
+static polygon_callbacks_t *Polygon_FindCallbacks(void *(*alloccallback)(int numbytes), void (*freecallback)(void *p))
+{
+	for(polygon_callbacks_t *c = polygon_callbacks.load(std::memory_order_acquire); c; c = c->next)
+	{
+		if(c->alloc == alloccallback && c->free == freecallback)
+			return c;
+	}
+
+	return NULL;
+}
 
 void Polygon_SetMemCallbacks(void *(*alloccallback)(int numbytes), void (*freecallback)(void *p))
 {
-	Polygon_MemAlloc	= alloccallback;
-	Polygon_MemFree		= freecallback;
+	if(!alloccallback || !freecallback)
+	{
+		Allocator_SetGlobal(NULL);
+		return;
+	}
+
+	polygon_callbacks_t *c = Polygon_FindCallbacks(alloccallback, freecallback);
+
+	// two threads adding the same pair at once both push it, which is harmless
+	if(!c)
+	{
+		c = new polygon_callbacks_t;
+
+		c->allocator.alloc	= Polygon_CallbackAlloc;
+		c->allocator.free	= Polygon_CallbackFree;
+		c->allocator.context	= c;
+		c->alloc		= alloccallback;
+		c->free			= freecallback;
+		c->next			= polygon_callbacks.load(std::memory_order_relaxed);
+
+		while(!polygon_callbacks.compare_exchange_weak(c->next, c, std::memory_order_release, std::memory_order_relaxed))
+			;
+	}
+
+	Allocator_SetGlobal(&c->allocator);
 }
 
-static int Polygon_MemSize(int maxvertices)
+int Polygon_MemSize(int maxvertices)
 {
 	return sizeof(polygon_t) + (maxvertices * sizeof(vec3));
 }
 
 polygon_t *Polygon_Alloc(int maxvertices)
+{
+	return Polygon_AllocWith(Allocator_Current(), maxvertices);
+}
+
+polygon_t *Polygon_AllocWith(allocator_t *a, int maxvertices)
 {
 	polygon_t	*p;
 
 	int numbytes = Polygon_MemSize(maxvertices);
-	p = (polygon_t*)Polygon_MemAlloc(numbytes);
+	p = (polygon_t*)Allocator_Alloc(a, numbytes);
 
 	p->maxvertices	= maxvertices;
 	p->numvertices	= 0;
 	p->vertices	= (vec3*)(p + 1);
+	p->allocator	= a;
 
 	return p;
 }
 
 void Polygon_Free(polygon_t* p)
 {
-	Polygon_MemFree(p);
+	Allocator_Free(p->allocator, p);
 }
 
 polygon_t* Polygon_Copy(polygon_t* p)
 {
 	polygon_t	*c;
 
-	int numbytes = Polygon_MemSize(p->maxvertices);
-	c = (polygon_t*)Polygon_MemAlloc(numbytes);
+	c = Polygon_Alloc(p->maxvertices);
+	c->numvertices = p->numvertices;
 
-	memcpy(c, p, numbytes);
+	memcpy(c->vertices, p->vertices, p->numvertices * sizeof(vec3));
 
 	return c;
 }
@@ -64,6 +117,7 @@ polygon_t *Polygon_Reverse(polygon_t* p)
 	polygon_t	*r;
 
 	r = (polygon_t*)Polygon_Alloc(p->maxvertices);
+	r->numvertices = p->numvertices;
 
 	for(int i = 0; i < p->numvertices; i++)
 		r->vertices[(i + 1) % p->numvertices] = p->vertices[p->numvertices - 1 - i];
@@ -73,21 +127,7 @@ polygon_t *Polygon_Reverse(polygon_t* p)
 
 void Polygon_BoundingBox(polygon_t* p, vec3* bmin, vec3* bmax)
 {
-	*bmin = vec3( 1e20f,  1e20f,  1e20f);
-	*bmax = vec3(-1e20f, -1e20f, -1e20f);
-
-	for(int i = 0; i < p->numvertices; i++)
-	{
-		vec3 *v = p->vertices + i;
-
-		for(int j = 0; j < 3; j++)
-		{
-			if(v[j] < bmin[j])
-				bmin[j] = v[j];
-			if(v[j] > bmax[j])
-				bmax[j] = v[j];
-		}
-	}
+	Bounds_FromPoints(p->vertices, p->numvertices, bmin, bmax);
 }
 
 vec3 Polygon_Centroid(polygon_t* p)
@@ -105,9 +145,9 @@ vec3 Polygon_Centroid(polygon_t* p)
 
 static vec3 Polygon_TriCrossVector(float v0[3], float v1[3], float v2[3])
 {
-	float x = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
+	float x = (v1[1] - v0[1]) * (v2[2] - v0[2]) - (v2[1] - v0[1]) * (v1[2] - v0[2]);
 	float y = (v1[2] - v0[2]) * (v2[0] - v0[0]) - (v2[2] - v0[2]) * (v1[0] - v0[0]);
-	float z = (v1[1] - v0[1]) * (v2[2] - v0[2]) - (v2[1] - v0[1]) * (v1[2] - v0[2]);
+	float z = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
 
 	return vec3(x, y, z);
 }
@@ -183,150 +223,216 @@ vec3 Polygon_Normal(polygon_t *p)
 	return Polygon_NormalFromArea(p);
 }
 
-void Polygon_SplitWithPlane(polygon_t *in, vec3 normal, float dist, float epsilon, polygon_t **front, polygon_t **back)
+// polygons of up to this many vertices keep their plane distances on the
+// stack between the classify and split passes, bigger ones compute them
+// again so a split never allocates
+#define POLYGON_SPLIT_INLINE	32
+
+static inline float Polygon_PlaneDist(const vec3& v, const vec3& normal, float dist, int type)
 {
-	float	dists[32+4];
-	int		sides[32+4];
-	int		counts[3];		// FRONT, BACK, ON
-	static	float dot;		// VC 4.2 optimizer bug if not static
-	int		i, j;
-	vec3	p1, p2;
-	vec3	mid;
-	polygon_t	*f, *b;
-	int		maxpts;
-	
+	// axial planes only need one component per point
+	if(type < PLANE_NONAXIAL)
+	{
+		return (normal[type] * v[type]) - dist;
+	}
+
+	return Dot(v, normal) - dist;
+}
+
+static inline int Polygon_DistSide(float d, float epsilon)
+{
+	if(d > epsilon)
+	{
+		return POLYGON_SIDE_FRONT;
+	}
+
+	if(d < -epsilon)
+	{
+		return POLYGON_SIDE_BACK;
+	}
+
+	return POLYGON_SIDE_ON;
+}
+
+// the side of the whole polygon. dists gets the distance of every point
+// when it is not NULL, with room for one more
+static int Polygon_ClassifyPoints(polygon_t *in, vec3 normal, float dist, float epsilon, int type, float *dists)
+{
+	int		counts[3];		// ON, FRONT, BACK
+
 	counts[0] = counts[1] = counts[2] = 0;
 
-	// classify each point
+	for(int i = 0; i < in->numvertices; i++)
 	{
-		for(i = 0; i < in->numvertices; i++)
-		{
-			dists[i] = Dot(in->vertices[i], normal) + dist;
-			
-			if(dot > epsilon)
-			{
-				sides[i] = POLYGON_SIDE_FRONT;
-			}
-			else if(dot < -epsilon)
-			{
-				sides[i] = POLYGON_SIDE_BACK;
-			}
-			else
-			{
-				sides[i] = POLYGON_SIDE_ON;
-			}
-
-			counts[sides[i]]++;
-		}
+		float d = Polygon_PlaneDist(in->vertices[i], normal, dist, type);
 
-		sides[i] = sides[0];
-		dists[i] = dists[0];
+		if(dists)
+			dists[i] = d;
+
+		counts[Polygon_DistSide(d, epsilon)]++;
 	}
-	
+
 	// all points are on the plane
 	// fixme: what happens if the polygon is degenerate?
 	if(!counts[POLYGON_SIDE_FRONT] && !counts[POLYGON_SIDE_BACK])
 	{
-		*front = NULL;
-		*back = NULL;
-		return;
+		return POLYGON_SIDE_ON;
 	}
 
-	// all points are front side
 	if(!counts[POLYGON_SIDE_BACK])
 	{
-		*front = Polygon_Copy(in);
-		*back = NULL;
-		return;
+		return POLYGON_SIDE_FRONT;
 	}
 
-	// all points are back side
 	if(!counts[POLYGON_SIDE_FRONT])
 	{
-		*front = NULL;
-		*back = Polygon_Copy(in);
-		return;
+		return POLYGON_SIDE_BACK;
 	}
 
-	// split the polygon
-	maxpts = in->numvertices+4;	// cant use counts[0]+2 because
-								// of fp grouping errors
+	return POLYGON_SIDE_CROSS;
+}
+
+// builds the pieces of a polygon Polygon_ClassifyPoints found crossing the
+// plane into empty front and back, from its distances or recomputing them
+// when dists is NULL
+static void Polygon_SplitClassified(polygon_t *in, vec3 normal, float dist, float epsilon, int type, float *dists, polygon_t *front, polygon_t *back)
+{
+	float	frac;
+	int		i, j;
+	vec3	p1, p2;
+	vec3	mid;
+	float	d0, d1, d2;
+	int		s1, s2;
+
+	int numvertices = in->numvertices;
+
+	// walk each edge with the distances of both ends
+	d0 = dists ? dists[0] : Polygon_PlaneDist(in->vertices[0], normal, dist, type);
+	if(dists)
+		dists[numvertices] = d0;
+
+	d1 = d0;
+	s1 = Polygon_DistSide(d1, epsilon);
 
-	*front = f = Polygon_Alloc(maxpts);
-	*back = b = Polygon_Alloc(maxpts);
-		
-	for(i = 0; i < in->numvertices; i++)
+	for(i = 0; i < numvertices; i++, d1 = d2, s1 = s2)
 	{
 		p1 = in->vertices[i];
-		
-		if(sides[i] == POLYGON_SIDE_ON)
+		p2 = in->vertices[(i + 1) % numvertices];
+
+		if(dists)
+			d2 = dists[i + 1];
+		else
+			d2 = (i + 1 < numvertices) ? Polygon_PlaneDist(p2, normal, dist, type) : d0;
+
+		s2 = Polygon_DistSide(d2, epsilon);
+
+		if(s1 == POLYGON_SIDE_ON)
 		{
 			// Add the point to the front polygon
-			f->vertices[f->numvertices] = p1;
-			f->numvertices++;
+			front->vertices[front->numvertices++] = p1;
 
 			// Add the point to the back polygon
-			b->vertices[b->numvertices] = p1;
-			b->numvertices++;
-			
+			if(back)
+				back->vertices[back->numvertices++] = p1;
+
 			continue;
 		}
-	
-		if(sides[i] == POLYGON_SIDE_FRONT)
+
+		if(s1 == POLYGON_SIDE_FRONT)
 		{
-			// Add the point to the front polygon
-			f->vertices[f->numvertices] = p1;
-			f->numvertices++;
+			front->vertices[front->numvertices++] = p1;
 		}
-
-		if(sides[i] == POLYGON_SIDE_BACK)
+		else if(back)
 		{
-			b->vertices[b->numvertices] = p1;
-			b->numvertices++;
+			back->vertices[back->numvertices++] = p1;
 		}
 
 		// If the next point doesn't straddle the plane continue
-		if (sides[i+1] == POLYGON_SIDE_ON || sides[i+1] == sides[i])
+		if(s2 == POLYGON_SIDE_ON || s2 == s1)
 		{
 			continue;
 		}
-		
+
 		// The next point crosses the plane, so generate a split point
-		p2 = in->vertices[(i + 1) % in->numvertices];
-		
-		dot = dists[i] / (dists[i] - dists[i+1]);
+		frac = d1 / (d1 - d2);
 		for(j = 0; j < 3; j++)
-		{	
-			// avoid round off error when possible
-			if(normal[j] == 1)
-			{
-				mid[j] = dist;
-			}
-			else if(normal[j] == -1)
-			{
-				mid[j] = -dist;
-			}
-			else
-			{
-				mid[j] = p1[j] + dot * (p2[j] - p1[j]);
-			}
+		{
+			mid[j] = p1[j] + frac * (p2[j] - p1[j]);
 		}
-			
-		f->vertices[f->numvertices] = mid;
-		f->numvertices++;
-		b->vertices[b->numvertices] = mid;
-		b->numvertices++;
-	}
-	
-	if(f->numvertices > maxpts || b->numvertices > maxpts)
-	{
-		assert(0);
+
+		// avoid round off error on axial planes, the point is on the plane
+		if(type < PLANE_NONAXIAL)
+		{
+			mid[type] = dist / normal[type];
+		}
+
+		front->vertices[front->numvertices++] = mid;
+		if(back)
+			back->vertices[back->numvertices++] = mid;
 	}
 
-	if (f->numvertices > 32 || b->numvertices > 32)
+	// more than two crossings means the input was not convex
+	assert(front->numvertices <= front->maxvertices);
+	assert(!back || back->numvertices <= back->maxvertices);
+}
+
+int Polygon_SplitInto(polygon_t *in, vec3 normal, float dist, float epsilon, polygon_t *front, polygon_t *back)
+{
+	float	dists[POLYGON_SPLIT_INLINE + 1];
+
+	int numvertices = in->numvertices;
+	float *stored = (numvertices <= POLYGON_SPLIT_INLINE) ? dists : NULL;
+
+	assert(front->maxvertices >= POLYGON_SPLIT_VERTICES(numvertices));
+	assert(!back || back->maxvertices >= POLYGON_SPLIT_VERTICES(numvertices));
+
+	front->numvertices = 0;
+	if(back)
+		back->numvertices = 0;
+
+	int type = Plane_TypeForNormal(normal.x, normal.y, normal.z);
+	int side = Polygon_ClassifyPoints(in, normal, dist, epsilon, type, stored);
+
+	if(side == POLYGON_SIDE_CROSS)
+		Polygon_SplitClassified(in, normal, dist, epsilon, type, stored, front, back);
+
+	return side;
+}
+
+void Polygon_SplitWithPlane(polygon_t *in, vec3 normal, float dist, float epsilon, polygon_t **front, polygon_t **back)
+{
+	float	dists[POLYGON_SPLIT_INLINE + 1];
+	int		maxpts;
+
+	float *stored = (in->numvertices <= POLYGON_SPLIT_INLINE) ? dists : NULL;
+
+	int type = Plane_TypeForNormal(normal.x, normal.y, normal.z);
+
+	// only a crossing needs new storage, a polygon on one side is copied whole
+	switch(Polygon_ClassifyPoints(in, normal, dist, epsilon, type, stored))
 	{
-		assert(0);
+	case POLYGON_SIDE_FRONT:
+		*front = Polygon_Copy(in);
+		*back = NULL;
+		return;
+
+	case POLYGON_SIDE_BACK:
+		*front = NULL;
+		*back = Polygon_Copy(in);
+		return;
+
+	case POLYGON_SIDE_ON:
+		*front = NULL;
+		*back = NULL;
+		return;
 	}
+
+	maxpts = POLYGON_SPLIT_VERTICES(in->numvertices);
+
+	*front = Polygon_Alloc(maxpts);
+	*back = Polygon_Alloc(maxpts);
+
+	Polygon_SplitClassified(in, normal, dist, epsilon, type, stored, *front, *back);
 }
 
 // Classify where a polygon is with respect to a plane
@@ -339,10 +445,12 @@ int Polygon_OnPlaneSide(polygon_t *p, vec3 normal, float dist, float epsilon)
 	front = 0;
 	back = 0;
 
+	int type = Plane_TypeForNormal(normal.x, normal.y, normal.z);
+
 	for(i = 0; i < p->numvertices; i++)
 	{
-		d = Dot(p->vertices[i], normal) - dist;
-		
+		d = Polygon_PlaneDist(p->vertices[i], normal, dist, type);
+
 		if(d < -epsilon)
 		{
 			if(front)
@@ -402,4 +510,40 @@ static float Polygon_TriangleProjectedArea(int axis, float v0[3], float v1[3], f
 }
 #endif
 
+// start + fraction * dir is on the plane of a convex polygon and inside
+// every edge. both faces are hit
+bool Polygon_RayIntersection(polygon_t *p, vec3 start, vec3 dir, float *fraction)
+{
+	float	f;
 
+	vec3 n = Polygon_ProjectedArea(p);
+	if(LengthSquared(n) == 0.0f)
+	{
+		return false;
+	}
+
+	n = Normalize(n);
+
+	plane_t plane(n, Dot(n, p->vertices[0]));
+	if(!plane.RayIntersection(start, dir, &f))
+	{
+		return false;
+	}
+
+	vec3 hit = start + f * dir;
+
+	// the edge normals point inwards for vertices wound around n
+	for(int i = 0; i < p->numvertices; i++)
+	{
+		vec3 v0 = p->vertices[i];
+		vec3 v1 = p->vertices[(i + 1) % p->numvertices];
+
+		if(Dot(Cross(n, v1 - v0), hit - v0) < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	*fraction = f;
+	return true;
+}
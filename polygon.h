@@ -2,12 +2,14 @@
 #define __POLYGON_H__
 
 #include "vector.h"
+#include "allocator.h"
 
 typedef struct polygon_s
 {
-	int	maxvertices;
-	int	numvertices;
-	vec3	*vertices;
+	int		maxvertices;
+	int		numvertices;
+	vec3		*vertices;
+	allocator_t	*allocator;	// Polygon_Free returns the memory here
 
 } polygon_t;
 
@@ -16,8 +18,20 @@ typedef struct polygon_s
 #define POLYGON_SIDE_BACK	2
 #define POLYGON_SIDE_CROSS	3
 
+// vertices a split output needs for an input of n vertices
+#define POLYGON_SPLIT_VERTICES(n)	((n) + 4)
+
+// new polygons come from Allocator_Current, the allocator bound to the
+// calling thread and then the global one, the same order as Volume_Alloc.
+// the callbacks take no context and are installed as the global allocator,
+// either one NULL restores the default. every polygon is freed through the
+// pair it was allocated with, so the callbacks may be switched at any time.
+// each distinct pair is kept for the life of the process
 void Polygon_SetMemCallbacks(void *(*alloccallback)(int numbytes), void (*freecallback)(void *p));
+// bytes requested from the allocator for a polygon of maxvertices
+int Polygon_MemSize(int maxvertices);
 polygon_t *Polygon_Alloc(int maxvertices);
+polygon_t *Polygon_AllocWith(allocator_t *a, int maxvertices);
 void Polygon_Free(polygon_t* p);
 polygon_t* Polygon_Copy(polygon_t* p);
 polygon_t *Polygon_Reverse(polygon_t* p);
@@ -27,7 +41,14 @@ float Polygon_Area(polygon_t* p);
 vec3 Polygon_ProjectedArea(polygon_t *p);
 vec3 Polygon_Normal(polygon_t* p);
 void Polygon_SplitWithPlane(polygon_t *in, vec3 normal, float dist, float epsilon, polygon_t **front, polygon_t **back);
+
+// splits a convex polygon into caller polygons with room for at least
+// POLYGON_SPLIT_VERTICES(in->numvertices), without allocating. returns
+// POLYGON_SIDE_CROSS with the pieces in front and back, otherwise the side
+// in is on with both left empty. a NULL back clips, keeping the front only
+int Polygon_SplitInto(polygon_t *in, vec3 normal, float dist, float epsilon, polygon_t *front, polygon_t *back);
 int Polygon_OnPlaneSide(polygon_t *p, vec3 normal, float dist, float epsilon);
+bool Polygon_RayIntersection(polygon_t *p, vec3 start, vec3 dir, float *fraction);
 
 #endif
 
@@ -0,0 +1,432 @@
+#include <assert.h>
+#include <atomic>
+#include <stdlib.h>
+#include "polypool.h"
+#include "polygon.h"
+
+// in front of every block, holds the size class or POLYPOOL_OVERSIZE
+#define POLYPOOL_HEADERSIZE	16
+#define POLYPOOL_OVERSIZE	(-1)
+
+// batch descriptors are allocated in chunks that are never freed, so a
+// stale index read during a pop still points at a descriptor
+#define POLYPOOL_CHUNKBATCHES	4096
+#define POLYPOOL_MAXCHUNKS	4096
+
+typedef struct polypool_block_s
+{
+	struct polypool_block_s	*next;
+
+} polypool_block_t;
+
+typedef struct polypool_list_s
+{
+	polypool_block_t	*head;
+	int			count;
+
+} polypool_list_t;
+
+typedef struct polypool_batch_s
+{
+	polypool_list_t			blocks;
+	std::atomic<unsigned int>	next;	// index + 1 of the batch below, 0 for none
+
+} polypool_batch_t;
+
+typedef struct polypool_counts_s
+{
+	long long	hits;
+	long long	misses;
+	long long	oversize;
+	long long	batches;
+
+} polypool_counts_t;
+
+typedef struct polypool_cache_s
+{
+	polypool_list_t		lists[POLYPOOL_NUMCLASSES];
+	polypool_counts_t	counts;
+
+	~polypool_cache_s();
+
+} polypool_cache_t;
+
+static const int polypool_classvertices[POLYPOOL_NUMCLASSES] = { 4, 8, 12, 16, 24, 32, 48, 64 };
+
+// the global lists are lock free stacks of batches, one per class plus one
+// of spare descriptors. the top word of a stack is a tag bumped on every
+// change, the bottom word is the top batch index + 1
+static std::atomic<unsigned long long>	polypool_stacks[POLYPOOL_NUMCLASSES];
+static std::atomic<unsigned long long>	polypool_spare(0);
+static std::atomic<polypool_batch_t*>	polypool_chunks[POLYPOOL_MAXCHUNKS];
+static std::atomic<unsigned int>	polypool_numbatches(0);
+
+static std::atomic<long long>	polypool_hits(0);
+static std::atomic<long long>	polypool_misses(0);
+static std::atomic<long long>	polypool_oversize(0);
+static std::atomic<long long>	polypool_batches(0);
+static std::atomic<bool>	polypool_usecaches(true);
+
+static thread_local polypool_cache_t polypool_cache;
+
+static int PolyPool_ClassBytes(int c)
+{
+	return Polygon_MemSize(polypool_classvertices[c]);
+}
+
+static int PolyPool_ClassForSize(int numbytes)
+{
+	for(int c = 0; c < POLYPOOL_NUMCLASSES; c++)
+	{
+		if(numbytes <= PolyPool_ClassBytes(c))
+			return c;
+	}
+
+	return POLYPOOL_OVERSIZE;
+}
+
+static void *PolyPool_SetHeader(void *block, int c)
+{
+	*(int*)block = c;
+	return (char*)block + POLYPOOL_HEADERSIZE;
+}
+
+static int PolyPool_GetHeader(void *p)
+{
+	return *(int*)((char*)p - POLYPOOL_HEADERSIZE);
+}
+
+/*-----------------------------------------------------------------------------
+	lists
+-----------------------------------------------------------------------------*/
+
+static void PolyPool_Push(polypool_list_t *l, polypool_block_t *b)
+{
+	b->next = l->head;
+	l->head = b;
+	l->count++;
+}
+
+static polypool_block_t *PolyPool_Pop(polypool_list_t *l)
+{
+	polypool_block_t *b = l->head;
+
+	if(b)
+	{
+		l->head = b->next;
+		l->count--;
+	}
+
+	return b;
+}
+
+// moves the last count blocks of src, the longest since they were freed,
+// into an empty dst
+static void PolyPool_SplitTail(polypool_list_t *dst, polypool_list_t *src, int count)
+{
+	assert(count > 0 && count < src->count);
+
+	polypool_block_t *last = src->head;
+
+	for(int i = 1; i < src->count - count; i++)
+		last = last->next;
+
+	dst->head = last->next;
+	dst->count = count;
+
+	last->next = NULL;
+	src->count -= count;
+}
+
+static void PolyPool_FlushCounts(polypool_counts_t *counts)
+{
+	polypool_hits.fetch_add(counts->hits, std::memory_order_relaxed);
+	polypool_misses.fetch_add(counts->misses, std::memory_order_relaxed);
+	polypool_oversize.fetch_add(counts->oversize, std::memory_order_relaxed);
+	polypool_batches.fetch_add(counts->batches, std::memory_order_relaxed);
+
+	counts->hits = counts->misses = counts->oversize = counts->batches = 0;
+}
+
+// carves a slab into blocks of class c, headers included. the list is
+// left empty if malloc fails
+static void PolyPool_NewSlab(polypool_list_t *l, int c)
+{
+	int blockbytes = (POLYPOOL_HEADERSIZE + PolyPool_ClassBytes(c) + 15) & ~15;
+	char *slab = (char*)malloc(blockbytes * POLYPOOL_SLAB);
+	if(!slab)
+		return;
+
+	for(int i = 0; i < POLYPOOL_SLAB; i++)
+		PolyPool_Push(l, (polypool_block_t*)PolyPool_SetHeader(slab + (i * blockbytes), c));
+}
+
+/*-----------------------------------------------------------------------------
+	global batches
+-----------------------------------------------------------------------------*/
+
+static polypool_batch_t *PolyPool_Batch(unsigned int index)
+{
+	return polypool_chunks[index / POLYPOOL_CHUNKBATCHES].load(std::memory_order_acquire) + (index % POLYPOOL_CHUNKBATCHES);
+}
+
+static void PolyPool_StackPush(std::atomic<unsigned long long> *stack, unsigned int index)
+{
+	polypool_batch_t	*b = PolyPool_Batch(index);
+	unsigned long long	top = stack->load(std::memory_order_relaxed);
+	unsigned long long	newtop;
+
+	do
+	{
+		b->next.store((unsigned int)top, std::memory_order_relaxed);
+		newtop = (((top >> 32) + 1) << 32) | (index + 1);
+	}
+	while(!stack->compare_exchange_weak(top, newtop, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// the tag makes the exchange fail if the top batch was popped and pushed
+// back in between, when its next may have changed
+static int PolyPool_StackPop(std::atomic<unsigned long long> *stack)
+{
+	unsigned long long	top = stack->load(std::memory_order_acquire);
+	unsigned long long	newtop;
+
+	do
+	{
+		unsigned int first = (unsigned int)top;
+		if(!first)
+			return -1;
+
+		newtop = (((top >> 32) + 1) << 32) | PolyPool_Batch(first - 1)->next.load(std::memory_order_relaxed);
+	}
+	while(!stack->compare_exchange_weak(top, newtop, std::memory_order_acquire, std::memory_order_acquire));
+
+	return (int)(unsigned int)top - 1;
+}
+
+static unsigned int PolyPool_NewBatch()
+{
+	int spare = PolyPool_StackPop(&polypool_spare);
+	if(spare >= 0)
+	{
+		return spare;
+	}
+
+	unsigned int index = polypool_numbatches.fetch_add(1, std::memory_order_relaxed);
+	assert(index < POLYPOOL_CHUNKBATCHES * POLYPOOL_MAXCHUNKS);
+
+	std::atomic<polypool_batch_t*> *chunk = &polypool_chunks[index / POLYPOOL_CHUNKBATCHES];
+
+	if(!chunk->load(std::memory_order_acquire))
+	{
+		polypool_batch_t *fresh = new polypool_batch_t[POLYPOOL_CHUNKBATCHES];
+		polypool_batch_t *expected = NULL;
+
+		if(!chunk->compare_exchange_strong(expected, fresh, std::memory_order_acq_rel))
+			delete[] fresh;
+	}
+
+	return index;
+}
+
+// hands a whole list to the global stack of class c
+static void PolyPool_PushBatch(int c, polypool_list_t *l)
+{
+	unsigned int index = PolyPool_NewBatch();
+
+	PolyPool_Batch(index)->blocks = *l;
+	PolyPool_StackPush(&polypool_stacks[c], index);
+
+	l->head = NULL;
+	l->count = 0;
+}
+
+// takes the top batch of class c into an empty list
+static bool PolyPool_PopBatch(int c, polypool_list_t *l)
+{
+	int index = PolyPool_StackPop(&polypool_stacks[c]);
+	if(index < 0)
+	{
+		return false;
+	}
+
+	*l = PolyPool_Batch(index)->blocks;
+	PolyPool_StackPush(&polypool_spare, index);
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	thread caches
+-----------------------------------------------------------------------------*/
+
+polypool_cache_s::~polypool_cache_s()
+{
+	PolyPool_FlushThreadCache();
+}
+
+void PolyPool_FlushThreadCache()
+{
+	polypool_cache_t *cache = &polypool_cache;
+
+	for(int c = 0; c < POLYPOOL_NUMCLASSES; c++)
+	{
+		if(cache->lists[c].head)
+			PolyPool_PushBatch(c, &cache->lists[c]);
+	}
+
+	PolyPool_FlushCounts(&cache->counts);
+}
+
+static void *PolyPool_CacheAlloc(polypool_cache_t *cache, int c)
+{
+	polypool_list_t *l = &cache->lists[c];
+
+	if(!l->head)
+	{
+		if(!PolyPool_PopBatch(c, l))
+		{
+			cache->counts.misses++;
+			PolyPool_NewSlab(l, c);
+			PolyPool_FlushCounts(&cache->counts);
+
+			return PolyPool_Pop(l);
+		}
+
+		cache->counts.batches++;
+		PolyPool_FlushCounts(&cache->counts);
+	}
+
+	cache->counts.hits++;
+	return PolyPool_Pop(l);
+}
+
+static void PolyPool_CacheFree(polypool_cache_t *cache, int c, polypool_block_t *b)
+{
+	polypool_list_t *l = &cache->lists[c];
+
+	PolyPool_Push(l, b);
+
+	// the blocks just freed are the ones still in cache, so the batch is
+	// taken from the cold end
+	if(l->count > POLYPOOL_CACHE_MAX)
+	{
+		polypool_list_t batch;
+
+		PolyPool_SplitTail(&batch, l, POLYPOOL_BATCH);
+		PolyPool_PushBatch(c, &batch);
+
+		cache->counts.batches++;
+		PolyPool_FlushCounts(&cache->counts);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	uncached
+
+	every call goes to the global stacks, a free becomes a batch of one
+-----------------------------------------------------------------------------*/
+
+static void *PolyPool_GlobalAlloc(int c)
+{
+	polypool_list_t l;
+
+	if(PolyPool_PopBatch(c, &l))
+	{
+		polypool_hits.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		polypool_misses.fetch_add(1, std::memory_order_relaxed);
+
+		l.head = NULL;
+		l.count = 0;
+		PolyPool_NewSlab(&l, c);
+	}
+
+	void *p = PolyPool_Pop(&l);
+
+	if(l.head)
+		PolyPool_PushBatch(c, &l);
+
+	return p;
+}
+
+static void PolyPool_GlobalFree(int c, polypool_block_t *b)
+{
+	polypool_list_t l = { NULL, 0 };
+
+	PolyPool_Push(&l, b);
+	PolyPool_PushBatch(c, &l);
+}
+
+/*-----------------------------------------------------------------------------
+	public interface
+-----------------------------------------------------------------------------*/
+
+void *PolyPool_MemAlloc(int numbytes)
+{
+	int c = PolyPool_ClassForSize(numbytes);
+
+	if(c == POLYPOOL_OVERSIZE)
+	{
+		void *block = malloc(POLYPOOL_HEADERSIZE + numbytes);
+		if(!block)
+			return NULL;
+
+		polypool_oversize.fetch_add(1, std::memory_order_relaxed);
+		return PolyPool_SetHeader(block, POLYPOOL_OVERSIZE);
+	}
+
+	if(polypool_usecaches.load(std::memory_order_relaxed))
+	{
+		return PolyPool_CacheAlloc(&polypool_cache, c);
+	}
+
+	return PolyPool_GlobalAlloc(c);
+}
+
+void PolyPool_MemFree(void *p)
+{
+	if(!p)
+	{
+		return;
+	}
+
+	int c = PolyPool_GetHeader(p);
+
+	if(c == POLYPOOL_OVERSIZE)
+	{
+		free((char*)p - POLYPOOL_HEADERSIZE);
+		return;
+	}
+
+	if(polypool_usecaches.load(std::memory_order_relaxed))
+	{
+		PolyPool_CacheFree(&polypool_cache, c, (polypool_block_t*)p);
+		return;
+	}
+
+	PolyPool_GlobalFree(c, (polypool_block_t*)p);
+}
+
+void PolyPool_SetThreadCaches(bool enable)
+{
+	polypool_usecaches.store(enable, std::memory_order_relaxed);
+}
+
+void PolyPool_GetStats(polypool_stats_t *stats)
+{
+	stats->hits	= polypool_hits.load(std::memory_order_relaxed);
+	stats->misses	= polypool_misses.load(std::memory_order_relaxed);
+	stats->oversize	= polypool_oversize.load(std::memory_order_relaxed);
+	stats->batches	= polypool_batches.load(std::memory_order_relaxed);
+}
+
+void PolyPool_ResetStats()
+{
+	polypool_hits		= 0;
+	polypool_misses		= 0;
+	polypool_oversize	= 0;
+	polypool_batches	= 0;
+}
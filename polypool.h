@@ -0,0 +1,59 @@
+/*=============================================================================
+	polypool.h
+============================================================================*/
+
+#ifndef __POLYPOOL_H__
+#define __POLYPOOL_H__
+
+// size classes hold polygons of up to 4, 8, 12, 16, 24, 32, 48 and 64
+// vertices, anything bigger goes straight to malloc
+#define POLYPOOL_NUMCLASSES	8
+
+// a thread cache holding more than POLYPOOL_CACHE_MAX blocks of a class
+// returns the POLYPOOL_BATCH least recently freed to the global pool, and an
+// empty one takes up to POLYPOOL_BATCH back. a miss carves POLYPOOL_SLAB new
+// blocks
+#define POLYPOOL_CACHE_MAX	128
+#define POLYPOOL_BATCH		32
+#define POLYPOOL_SLAB		64
+
+/*-----------------------------------------------------------------------------
+	polygon pool
+
+	size classed free lists keyed on Polygon_MemSize, for
+	Polygon_SetMemCallbacks(PolyPool_MemAlloc, PolyPool_MemFree). the free
+	blocks are linked through their own memory and slabs are kept for the
+	life of the process.
+
+	with thread caches on, the default, each thread allocates and frees
+	from its own lists and only touches the global lists a batch at a time.
+	the global lists are lock free, so no call ever waits on another
+	thread. blocks may be freed by a different thread than allocated them
+-----------------------------------------------------------------------------*/
+
+typedef struct polypool_stats_s
+{
+	long long	hits;		// served from a free list
+	long long	misses;		// carved from a new slab
+	long long	oversize;	// too big for any class
+	long long	batches;	// batches taken from or given to the global lists
+
+} polypool_stats_t;
+
+void *PolyPool_MemAlloc(int numbytes);
+void PolyPool_MemFree(void *p);
+
+// either path frees the blocks of the other, so this may be switched while
+// other threads allocate
+void PolyPool_SetThreadCaches(bool enable);
+
+// hands the calling thread's blocks to the global pool, also done when a
+// thread exits
+void PolyPool_FlushThreadCache();
+
+// thread caches add their counts in when they flush or make a batch trip,
+// so the totals lag a little behind
+void PolyPool_GetStats(polypool_stats_t *stats);
+void PolyPool_ResetStats();
+
+#endif
@@ -1,5 +1,31 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
 #include "polygon.h"
+#include "simd.h"
+#include "vec3soa.h"
+#include "parallel.h"
+#include "matrix.h"
+#include "tvector.h"
+#include "tmatrix.h"
+#include "vecexpr.h"
+#include "vertexstream.h"
+#include "bounds.h"
+#include "transform.h"
+#include "matrixbatch.h"
+#include "hierarchy.h"
+#include "frustum.h"
+#include "plane.h"
+#include "planeset.h"
+#include "planepool.h"
+#include "raypacket.h"
+#include "arena.h"
+#include "polypool.h"
+#include "volume.h"
+#include "allocator.h"
 
 static void PrintPolygon(polygon_t *p)
 {
@@ -95,6 +121,2452 @@ static void Polygon_Test5()
 	printf("area: %f\n", Polygon_Area(p));
 }
 
+static void Polygon_Test6()
+{
+	polygon_t* p = Polygon_Alloc(5);
+
+	p->numvertices = 5;
+	p->vertices[0] = vec3(0, 0, -1);
+	p->vertices[1] = vec3(4, 0, 0);
+	p->vertices[2] = vec3(4, 4, 2);
+	p->vertices[3] = vec3(0, 4, 0);
+	p->vertices[4] = vec3(-3, 2, 0);
+
+	vec3 bmin, bmax;
+	Polygon_BoundingBox(p, &bmin, &bmax);
+	printf("bounds: %f %f %f, %f %f %f\n", bmin[0], bmin[1], bmin[2], bmax[0], bmax[1], bmax[2]);
+
+	Polygon_Free(p);
+}
+
+static void Polygon_Test7()
+{
+	polygon_t* p = Polygon_Alloc(4);
+	polygon_t *front, *back;
+
+	p->numvertices = 4;
+	p->vertices[0] = vec3(0, 0, 0);
+	p->vertices[1] = vec3(4, 0, 0);
+	p->vertices[2] = vec3(4, 4, 0);
+	p->vertices[3] = vec3(0, 4, 0);
+
+	// axial plane x = 1
+	Polygon_SplitWithPlane(p, vec3(1, 0, 0), 1, 0.01f, &front, &back);
+	PrintPolygon(front);
+	PrintPolygon(back);
+
+	Polygon_Free(front);
+	Polygon_Free(back);
+	Polygon_Free(p);
+}
+
+static void Polygon_Test8()
+{
+	polygon_t* p = Polygon_Alloc(4);
+	polygon_t* a = Polygon_Alloc(POLYGON_SPLIT_VERTICES(8));
+	polygon_t* b = Polygon_Alloc(POLYGON_SPLIT_VERTICES(8));
+	polygon_t* t;
+
+	p->numvertices = 4;
+	p->vertices[0] = vec3(0, 0, 0);
+	p->vertices[1] = vec3(4, 0, 0);
+	p->vertices[2] = vec3(4, 4, 0);
+	p->vertices[3] = vec3(0, 4, 0);
+
+	// clip to the front of two diagonal planes into reused buffers
+	vec3 normals[2] = { Normalize(vec3(1, 1, 0)), Normalize(vec3(-1, 1, 0)) };
+	float dists[2] = { 2, -1 };
+
+	a->numvertices = p->numvertices;
+	for(int i = 0; i < p->numvertices; i++)
+		a->vertices[i] = p->vertices[i];
+
+	for(int i = 0; i < 2; i++)
+	{
+		int side = Polygon_SplitInto(a, normals[i], dists[i], 0.01f, b, NULL);
+		printf("side: %i\n", side);
+
+		if(side == POLYGON_SIDE_CROSS)
+		{
+			t = a;
+			a = b;
+			b = t;
+		}
+	}
+
+	PrintPolygon(a);
+
+	Polygon_Free(p);
+	Polygon_Free(a);
+	Polygon_Free(b);
+}
+
+/*-----------------------------------------------------------------------------
+	batch kernel checks
+
+	the batch functions are run under every tier the host supports and
+	compared with the scalar tier, allowing for fma rounding
+-----------------------------------------------------------------------------*/
+
+static float Test_Random()
+{
+	return (((float)rand() / (float)RAND_MAX) * 2.0f) - 1.0f;
+}
+
+static int Test_Compare(const float *a, const float *b, int n, float tolerance)
+{
+	int failures = 0;
+
+	for(int i = 0; i < n; i++)
+	{
+		if(!(fabsf(a[i] - b[i]) <= tolerance * (1.0f + fabsf(b[i]))))
+			failures++;
+	}
+
+	return failures;
+}
+
+static int Test_CompareVec3(const vec3 *a, const vec3 *b, int n, float tolerance)
+{
+	int failures = 0;
+
+	for(int i = 0; i < n; i++)
+		failures += Test_Compare(&a[i].x, &b[i].x, 3, tolerance);
+
+	return failures;
+}
+
+static void Test_Report(const char *name, int failures)
+{
+	printf("%s: %s\n", name, failures ? "FAILED" : "ok");
+}
+
+static void Vec3SoA_Test1()
+{
+	const int n = 1001;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	vec3_soa *a = Vec3SoA_Alloc(n);
+	vec3_soa *b = Vec3SoA_Alloc(n);
+	vec3_soa *cross[2] = { Vec3SoA_Alloc(n), Vec3SoA_Alloc(n) };
+	vec3_soa *norm[2] = { Vec3SoA_Alloc(n), Vec3SoA_Alloc(n) };
+	float *dot[2] = { new float[n], new float[n] };
+	float *len[2] = { new float[n], new float[n] };
+
+	a->numvectors = b->numvectors = n;
+	for(int i = 0; i < n; i++)
+	{
+		a->x[i] = Test_Random(); a->y[i] = Test_Random(); a->z[i] = Test_Random() + 2.0f;
+		b->x[i] = Test_Random(); b->y[i] = Test_Random(); b->z[i] = Test_Random();
+	}
+
+	// slot 0 holds the scalar results, slot 1 each wider tier in turn
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		int k = (t > 0);
+
+		Simd_SetTier(t);
+		Vec3SoA_Dot(dot[k], a, b);
+		Vec3SoA_Cross(cross[k], a, b);
+		Vec3SoA_Length(len[k], a);
+		Vec3SoA_Normalize(norm[k], a);
+
+		if(!k)
+			continue;
+
+		failures += Test_Compare(dot[1], dot[0], n, 1e-5f);
+		failures += Test_Compare(len[1], len[0], n, 1e-5f);
+		failures += Test_Compare(cross[1]->x, cross[0]->x, n, 1e-5f);
+		failures += Test_Compare(cross[1]->z, cross[0]->z, n, 1e-5f);
+		failures += Test_Compare(norm[1]->y, norm[0]->y, n, 1e-5f);
+	}
+
+	// and the scalar tier against vector.h
+	for(int i = 0; i < n; i++)
+	{
+		vec3 va(a->x[i], a->y[i], a->z[i]);
+		vec3 vb(b->x[i], b->y[i], b->z[i]);
+
+		float d = Dot(va, vb);
+		failures += Test_Compare(&dot[0][i], &d, 1, 1e-6f);
+	}
+
+	Simd_SetTier(tier);
+	Test_Report("vec3soa", failures);
+
+	for(int k = 0; k < 2; k++)
+	{
+		Vec3SoA_Free(cross[k]);
+		Vec3SoA_Free(norm[k]);
+		delete[] dot[k];
+		delete[] len[k];
+	}
+	Vec3SoA_Free(a);
+	Vec3SoA_Free(b);
+}
+
+static void Simd_TestChunk(void *context, int start, int end)
+{
+	std::atomic<int> *mismatches = (std::atomic<int>*)context;
+
+	for(int i = start; i < end; i++)
+	{
+		if(Simd_GetTier() != Simd_SupportedTier())
+			(*mismatches)++;
+	}
+}
+
+static void Simd_Test1()
+{
+	int failures = 0;
+	int tier = Simd_GetTier();
+	int supported = Simd_SupportedTier();
+
+	for(int t = 0; t < SIMD_NUM_TIERS; t++)
+	{
+		int expect = (t < supported) ? t : supported;
+
+		if(Simd_SetTier(t) != expect || Simd_GetTier() != expect)
+			failures++;
+	}
+
+	// detection racing on first use from the workers. MATHLIB_SIMD would
+	// pin a lower tier, so only check when it is not set
+	if(!getenv(SIMD_ENV_VAR))
+	{
+		std::atomic<int> mismatches(0);
+
+		simd_tier.store(-1);
+		Parallel_For(1 << 16, 256, Simd_TestChunk, &mismatches);
+		failures += mismatches;
+	}
+
+	Simd_SetTier(tier);
+	Test_Report("simd", failures);
+}
+
+// every precision tier stays inside the error bound given in vector.h, for
+// InvSqrt and the batch normalize on each simd tier
+static void Normalize_Test1()
+{
+	const int n = 1000;
+	const float bounds[3] = { 2e-7f, 6e-6f, 2e-3f };
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	vec3_soa *v = Vec3SoA_Alloc(n);
+	vec3_soa *r = Vec3SoA_Alloc(n);
+
+	v->numvectors = n;
+	for(int i = 0; i < n; i++)
+	{
+		float s = expf(Test_Random() * 8.0f);
+
+		v->x[i] = Test_Random() * s;
+		v->y[i] = Test_Random() * s;
+		v->z[i] = (Test_Random() + 1.5f) * s;
+	}
+
+	for(int precision = NORMALIZE_EXACT; precision <= NORMALIZE_RSQRT; precision++)
+	{
+		for(int i = 0; i < n; i++)
+		{
+			float x = (v->x[i] * v->x[i]) + 1.0f;
+			double exact = 1.0 / sqrt((double)x);
+
+			if(fabs(InvSqrt(x, precision) - exact) > bounds[precision] * exact)
+				failures++;
+		}
+
+		for(int t = 0; t <= Simd_SupportedTier(); t++)
+		{
+			Simd_SetTier(t);
+			Vec3SoA_Normalize(r, v, precision);
+
+			for(int i = 0; i < n; i++)
+			{
+				double len = sqrt(((double)r->x[i] * r->x[i]) + ((double)r->y[i] * r->y[i]) + ((double)r->z[i] * r->z[i]));
+
+				if(fabs(len - 1.0) > 2.0 * bounds[precision] + 1e-6)
+					failures++;
+			}
+		}
+	}
+
+	Simd_SetTier(tier);
+	Test_Report("normalize", failures);
+
+	Vec3SoA_Free(v);
+	Vec3SoA_Free(r);
+}
+
+static mat4x4 Test_RandomMat4x4()
+{
+	mat4x4 m;
+
+	for(int i = 0; i < 4; i++)
+		m.SetRow(i, Test_Random(), Test_Random(), Test_Random(), Test_Random());
+
+	// keep it well conditioned
+	for(int i = 0; i < 4; i++)
+		m.m[i][i] += 3.0f;
+
+	return m;
+}
+
+static int Test_CompareMat4x4(const mat4x4& a, const mat4x4& b, float tolerance)
+{
+	return Test_Compare(a.m[0].Ptr(), b.m[0].Ptr(), 4, tolerance) +
+		Test_Compare(a.m[1].Ptr(), b.m[1].Ptr(), 4, tolerance) +
+		Test_Compare(a.m[2].Ptr(), b.m[2].Ptr(), 4, tolerance) +
+		Test_Compare(a.m[3].Ptr(), b.m[3].Ptr(), 4, tolerance);
+}
+
+// the register backed vec4 and mat4x4 against loops over plain floats
+static void Mat4x4_Test1()
+{
+	int failures = 0;
+
+	for(int k = 0; k < 100; k++)
+	{
+		mat4x4 a = Test_RandomMat4x4();
+		mat4x4 b = Test_RandomMat4x4();
+		vec4 v(Test_Random(), Test_Random(), Test_Random(), Test_Random());
+		mat4x4 ab, at, identity;
+		vec4 av;
+
+		for(int i = 0; i < 4; i++)
+		{
+			for(int j = 0; j < 4; j++)
+			{
+				ab.m[i][j] = 0.0f;
+				for(int e = 0; e < 4; e++)
+					ab.m[i][j] += a.m[i][e] * b.m[e][j];
+
+				at.m[i][j] = a.m[j][i];
+			}
+
+			av[i] = (a.m[i][0] * v[0]) + (a.m[i][1] * v[1]) + (a.m[i][2] * v[2]) + (a.m[i][3] * v[3]);
+		}
+
+		failures += Test_CompareMat4x4(a * b, ab, 1e-5f);
+
+		vec4 r = a * v;
+		failures += Test_Compare(r.Ptr(), av.Ptr(), 4, 1e-5f);
+
+		mat4x4 t = a;
+		t.Transpose();
+		failures += Test_CompareMat4x4(t, at, 0.0f);
+
+		mat4x4 inv = a;
+		if(!inv.Invert())
+			failures++;
+
+		identity.Identity();
+		failures += Test_CompareMat4x4(a * inv, identity, 1e-5f);
+
+		float len = sqrtf((v[0] * v[0]) + (v[1] * v[1]) + (v[2] * v[2]) + (v[3] * v[3]));
+		float l = v.Length();
+		failures += Test_Compare(&l, &len, 1, 1e-6f);
+	}
+
+	Test_Report("mat4x4", failures);
+}
+
+// folded at compile time, these fail the build rather than the run
+static constexpr vec3d tvec_a(1.0, 2.0, 3.0);
+static constexpr vec3d tvec_b(-2.0, 0.5, 4.0);
+static constexpr mat3x3d tmat_a(vec3d(2.0, 0.0, 1.0), vec3d(1.0, 3.0, 0.0), vec3d(0.0, 1.0, 4.0));
+
+static_assert(Dot(tvec_a, tvec_b) == 11.0, "constexpr Dot");
+static_assert(Cross(tvec_a, tvec_b) == vec3d(6.5, -10.0, 4.5), "constexpr Cross");
+static_assert((tvec_a + (2.0 * tvec_b)) == vec3d(-3.0, 3.0, 11.0), "constexpr arithmetic");
+static_assert(Determinant(tmat_a) == 25.0, "constexpr Determinant");
+static_assert((tmat_a * Inverse(tmat_a)) == mat3x3d::Identity(), "constexpr Inverse");
+static_assert(Transpose(Transpose(tmat_a)) == tmat_a, "constexpr Transpose");
+static_assert(Determinant(mat4x4f::Identity()) == 1.0f, "constexpr 4x4 Determinant");
+
+static void TVector_Test1()
+{
+	int failures = 0;
+
+	// the double instantiation has the range the float one lacks
+	vec3d d(3e20, 4e20, 0.0);
+	vec3f f = vec3f::Convert(d);
+
+	if(fabs(Length(d) - 5e20) > 1e6 || !isinf(Length(f)))
+		failures++;
+
+	// and matches the hand written classes
+	mat4x4 m = Test_RandomMat4x4();
+	mat4x4 inv = m;
+	inv.Invert();
+
+	mat4x4 t = ToMat4x4(Inverse(TMat<float>(m)));
+	failures += Test_CompareMat4x4(t, inv, 1e-5f);
+
+	Test_Report("tvector", failures);
+}
+
+// lazy array expressions against the same arithmetic written out per element
+static void VecExpr_Test1()
+{
+	const int n = 100;
+	int failures = 0;
+
+	vec3 a[n], b[n], out[n], acc[n];
+	vec4 c[n], d[n], out4[n];
+	float t[n];
+
+	for(int i = 0; i < n; i++)
+	{
+		a[i] = vec3(Test_Random(), Test_Random(), Test_Random());
+		b[i] = vec3(Test_Random(), Test_Random(), Test_Random());
+		c[i] = vec4(Test_Random(), Test_Random(), Test_Random(), Test_Random());
+		d[i] = vec4(Test_Random(), Test_Random(), Test_Random(), Test_Random());
+		t[i] = Test_Random();
+		acc[i] = a[i];
+	}
+
+	VArray(out, n) = VArray(a, n) + SArray(t, n) * (VArray(b, n) - VArray(a, n));
+	VArray(out4, n) = -(0.5f * VArray(c, n)) + VArray(d, n) / 2.0f;
+	VArray(acc, n) += VArray(b, n) * VArray(b, n);
+
+	for(int i = 0; i < n; i++)
+	{
+		vec3 e = a[i] + t[i] * (b[i] - a[i]);
+		vec4 e4 = -(0.5f * c[i]) + d[i] / 2.0f;
+		vec3 ea = a[i] + b[i] * b[i];
+
+		failures += Test_Compare(out[i].Ptr(), e.Ptr(), 3, 0.0f);
+		failures += Test_Compare(out4[i].Ptr(), e4.Ptr(), 4, 0.0f);
+		failures += Test_Compare(acc[i].Ptr(), ea.Ptr(), 3, 0.0f);
+	}
+
+	// the output may alias an operand
+	VArray(a, n) = VArray(a, n) * 2.0f;
+	for(int i = 0; i < n; i++)
+	{
+		vec3 e = acc[i] - (b[i] * b[i]);
+		failures += Test_Compare(a[i].Ptr(), (2.0f * e).Ptr(), 3, 1e-6f);
+	}
+
+	Test_Report("vecexpr", failures);
+}
+
+// compare the planes of two streams, returns the number of differing elements
+static int Test_CompareStreams(const vertexstream_t *a, const vertexstream_t *b)
+{
+	int failures = 0;
+
+	for(int j = 0; j < 3; j++)
+	{
+		if(!a->c[j])
+			continue;
+
+		for(int i = 0; i < a->numvertices; i++)
+		{
+			if(a->c[j][i] != b->c[j][i])
+				failures++;
+		}
+	}
+
+	return failures;
+}
+
+static void VertexStream_Test1()
+{
+	const int n = 1001;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	vec3 *points = new vec3[n];
+	vec3 *decoded = new vec3[n];
+	vec3_soa *soa = Vec3SoA_Alloc(n);
+
+	for(int i = 0; i < n; i++)
+	{
+		points[i] = vec3(Test_Random() * 100.0f, Test_Random(), Test_Random() * 0.01f + 5.0f);
+	}
+
+	// the octahedral format expects unit vectors
+	vec3 *normals = new vec3[n];
+	for(int i = 0; i < n; i++)
+	{
+		normals[i] = vec3(Test_Random(), Test_Random(), Test_Random() + 0.1f);
+		normals[i].Normalize();
+	}
+
+	for(int format = VERTEXSTREAM_HALF; format <= VERTEXSTREAM_OCTNORMAL; format++)
+	{
+		const vec3 *in = (format == VERTEXSTREAM_OCTNORMAL) ? normals : points;
+		vertexstream_t *ref = VertexStream_Alloc(format, n);
+		vertexstream_t *s = VertexStream_Alloc(format, n);
+
+		Vec3SoA_FromVec3(soa, in, n);
+
+		// every tier and both input layouts must produce the scalar encoding
+		for(int t = 0; t <= Simd_SupportedTier(); t++)
+		{
+			Simd_SetTier(t);
+
+			if(!t)
+			{
+				VertexStream_Encode(ref, in, n);
+			}
+
+			VertexStream_Encode(s, in, n);
+			failures += Test_CompareStreams(s, ref);
+
+			VertexStream_EncodeSoA(s, soa);
+			failures += Test_CompareStreams(s, ref);
+
+			if(s->bmin != ref->bmin || s->bmax != ref->bmax)
+				failures++;
+		}
+
+		// round trip within the format's precision. quant16 steps are a
+		// fraction of the bounds, halfs are relative, octahedral absolute
+		VertexStream_Decode(decoded, ref);
+		for(int i = 0; i < n; i++)
+		{
+			for(int j = 0; j < 3; j++)
+			{
+				float tolerance;
+
+				if(format == VERTEXSTREAM_QUANT16)
+					tolerance = (ref->bmax[j] - ref->bmin[j]) / 65535.0f;
+				else if(format == VERTEXSTREAM_HALF)
+					tolerance = fabsf(in[i][j]) * 1e-3f + 1e-7f;
+				else
+					tolerance = 1e-3f;
+
+				if(!(fabsf(decoded[i][j] - in[i][j]) <= tolerance))
+					failures++;
+			}
+		}
+
+		VertexStream_Free(s);
+		VertexStream_Free(ref);
+	}
+
+	// an empty quant16 stream keeps a zero box
+	vertexstream_t *empty = VertexStream_Alloc(VERTEXSTREAM_QUANT16, 4);
+	VertexStream_Encode(empty, points, 0);
+	if(empty->bmin != vec3_zero || empty->bmax != vec3_zero)
+		failures++;
+	VertexStream_Free(empty);
+
+	Simd_SetTier(tier);
+
+	Vec3SoA_Free(soa);
+	delete[] normals;
+	delete[] decoded;
+	delete[] points;
+
+	Test_Report("vertexstream", failures);
+}
+
+static void Bounds_Test1()
+{
+	const int n = 3001;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	polygon_t **polygons = new polygon_t*[n];
+	bounds_soa *b = Bounds_Alloc(n);
+
+	// mostly small polygons with some empty and some past the lane limit
+	for(int i = 0; i < n; i++)
+	{
+		int numvertices = 3 + (rand() % 6);
+
+		if(!(i % 97))
+			numvertices = 0;
+		else if(!(i % 89))
+			numvertices = 33 + (rand() % 40);
+
+		polygons[i] = Polygon_Alloc(numvertices);
+		polygons[i]->numvertices = numvertices;
+
+		for(int j = 0; j < numvertices; j++)
+		{
+			polygons[i]->vertices[j] = vec3(Test_Random(), Test_Random(), Test_Random()) * 100.0f;
+		}
+	}
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+		Bounds_FromPolygons(b, polygons, n);
+
+		// min and max are exact, so every tier matches the point reduction
+		for(int i = 0; i < n; i++)
+		{
+			vec3 bmin, bmax, rmin, rmax;
+
+			Bounds_Get(b, i, &bmin, &bmax);
+			Simd_SetTier(0);
+			Bounds_FromPoints(polygons[i]->vertices, polygons[i]->numvertices, &rmin, &rmax);
+			Simd_SetTier(t);
+
+			if(bmin != rmin || bmax != rmax)
+				failures++;
+		}
+	}
+
+	Simd_SetTier(tier);
+
+	for(int i = 0; i < n; i++)
+		Polygon_Free(polygons[i]);
+
+	Bounds_Free(b);
+	delete[] polygons;
+
+	Test_Report("bounds", failures);
+}
+
+static void Transform_Test1()
+{
+	const int n = 5003;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	// interleaved vertex with a trailing attribute the strided paths skip
+	typedef struct
+	{
+		vec3	xyz;
+		float	u, v;
+	} testvertex_t;
+
+	vec3 *in = new vec3[n];
+	vec3 *points = new vec3[n];
+	vec3 *vectors = new vec3[n];
+	vec3 *out = new vec3[n];
+	testvertex_t *strided = new testvertex_t[n];
+	vec3_soa *soain = Vec3SoA_Alloc(n);
+	vec3_soa *soaout = Vec3SoA_Alloc(n);
+
+	mat4x4 m4 = Test_RandomMat4x4();
+	mat3x4 m3(m4);
+	float m34[3][4];
+
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 4; j++)
+			m34[i][j] = m4.m[i][j];
+
+	for(int i = 0; i < n; i++)
+	{
+		in[i] = vec3(Test_Random(), Test_Random(), Test_Random()) * 10.0f;
+		points[i] = m3.TransformPoint(in[i]);
+		vectors[i] = m3.TransformVector(in[i]);
+	}
+
+	Vec3SoA_FromVec3(soain, in, n);
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+
+		// each matrix form against the per-vector reference
+		for(int form = 0; form < 3; form++)
+		{
+			for(int w = 0; w < 2; w++)
+			{
+				const vec3 *ref = w ? vectors : points;
+
+				if(form == 0)
+					w ? Transform_Vectors(out, m4, in, n) : Transform_Points(out, m4, in, n);
+				else if(form == 1)
+					w ? Transform_Vectors(out, m34, in, n) : Transform_Points(out, m34, in, n);
+				else
+					w ? Transform_Vectors(out, m3, in, n) : Transform_Points(out, m3, in, n);
+
+				failures += Test_CompareVec3(out, ref, n, 1e-5f);
+
+				if(form == 0)
+					w ? Transform_VectorsSoA(soaout, m4, soain) : Transform_PointsSoA(soaout, m4, soain);
+				else if(form == 1)
+					w ? Transform_VectorsSoA(soaout, m34, soain) : Transform_PointsSoA(soaout, m34, soain);
+				else
+					w ? Transform_VectorsSoA(soaout, m3, soain) : Transform_PointsSoA(soaout, m3, soain);
+
+				Vec3SoA_ToVec3(out, soaout);
+				failures += Test_CompareVec3(out, ref, n, 1e-5f);
+			}
+		}
+
+		// strided, transformed in place so u and v must survive
+		for(int i = 0; i < n; i++)
+		{
+			strided[i].xyz = in[i];
+			strided[i].u = (float)i;
+			strided[i].v = -(float)i;
+		}
+
+		Transform_PointsStrided(strided, sizeof(testvertex_t), m3, strided, sizeof(testvertex_t), n);
+
+		for(int i = 0; i < n; i++)
+		{
+			failures += Test_CompareVec3(&strided[i].xyz, &points[i], 1, 1e-5f);
+			if(strided[i].u != (float)i || strided[i].v != -(float)i)
+				failures++;
+		}
+
+		// in place on a plain array
+		for(int i = 0; i < n; i++)
+			out[i] = in[i];
+
+		Transform_Vectors(out, m4, out, n);
+		failures += Test_CompareVec3(out, vectors, n, 1e-5f);
+	}
+
+	Simd_SetTier(tier);
+
+	Vec3SoA_Free(soaout);
+	Vec3SoA_Free(soain);
+	delete[] strided;
+	delete[] out;
+	delete[] vectors;
+	delete[] points;
+	delete[] in;
+
+	Test_Report("transform", failures);
+}
+
+static vec4 Test_RandomQuat()
+{
+	vec4 q(Test_Random(), Test_Random(), Test_Random(), Test_Random() + 2.0f);
+
+	return q * (1.0f / sqrtf(Dot(q, q)));
+}
+
+// rotation matrix of a unit quaternion x y z w
+static mat3x3 Test_QuatRotation(const vec4& q)
+{
+	float x = q.x, y = q.y, z = q.z, w = q.w;
+
+	return mat3x3
+	(
+		1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z), 2.0f * (x * z + w * y),
+		2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x),
+		2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y)
+	);
+}
+
+static mat3x3 Test_RandomRotation()
+{
+	return Test_QuatRotation(Test_RandomQuat());
+}
+
+static int Test_CompareMat3x4(const mat3x4& a, const mat3x4& b, float tolerance)
+{
+	return Test_Compare(a.Ptr(), b.Ptr(), 12, tolerance);
+}
+
+static void Mat3x4_Test1()
+{
+	int failures = 0;
+	mat3x4 identity;
+
+	identity.Identity();
+
+	for(int i = 0; i < 1000; i++)
+	{
+		vec3 t(Test_Random() * 10.0f, Test_Random() * 10.0f, Test_Random() * 10.0f);
+		mat3x3 r = Test_RandomRotation();
+		mat3x4 rigid(r, t);
+
+		// columns scaled by 0.5 .. 2
+		mat3x3 rs = r;
+		for(int j = 0; j < 3; j++)
+		{
+			float s = 1.25f + Test_Random() * 0.75f;
+
+			for(int k = 0; k < 3; k++)
+				rs[k][j] *= s;
+		}
+		mat3x4 scaled(rs, t);
+
+		mat3x4 general(Test_RandomMat4x4());
+
+		// compose and transforms against the mat4x4 products
+		mat4x4 product = rigid.ToMat4x4() * general.ToMat4x4();
+		failures += Test_CompareMat3x4(rigid * general, mat3x4(product), 1e-5f);
+
+		vec4 p(Test_Random(), Test_Random(), Test_Random(), 1.0f);
+		vec4 ref = general.ToMat4x4() * p;
+		vec3 tp = general.TransformPoint(vec3(p.x, p.y, p.z));
+		vec3 tv = general.TransformVector(vec3(p.x, p.y, p.z));
+		vec4 rv = general.ToMat4x4() * vec4(p.x, p.y, p.z, 0.0f);
+
+		if(fabsf(tp.x - ref.x) > 1e-5f || fabsf(tp.y - ref.y) > 1e-5f || fabsf(tp.z - ref.z) > 1e-5f)
+			failures++;
+		if(fabsf(tv.x - rv.x) > 1e-5f || fabsf(tv.y - rv.y) > 1e-5f || fabsf(tv.z - rv.z) > 1e-5f)
+			failures++;
+
+		// every inverse path undoes its matrix and matches the general one
+		mat3x4 inv = rigid;
+		inv.InvertRigid();
+		failures += Test_CompareMat3x4(rigid * inv, identity, 1e-5f);
+
+		mat3x4 check = rigid;
+		if(!check.Invert())
+			failures++;
+		failures += Test_CompareMat3x4(check, inv, 1e-4f);
+
+		inv = scaled;
+		if(!inv.InvertScaled())
+			failures++;
+		failures += Test_CompareMat3x4(scaled * inv, identity, 1e-5f);
+		failures += Test_CompareMat3x4(inv * scaled, identity, 1e-5f);
+
+		inv = general;
+		if(!inv.Invert())
+			failures++;
+		failures += Test_CompareMat3x4(general * inv, identity, 1e-5f);
+
+		mat4x4 inv4 = general.ToMat4x4();
+		inv4.Invert();
+		failures += Test_CompareMat3x4(inv, mat3x4(inv4), 1e-4f);
+	}
+
+	// singular matrices are refused and left alone
+	mat3x4 flat(1.0f, 2.0f, 3.0f, 1.0f, 2.0f, 4.0f, 6.0f, 2.0f, 0.0f, 0.0f, 1.0f, 3.0f);
+	mat3x4 copy = flat;
+	if(flat.Invert() || flat != copy)
+		failures++;
+
+	mat3x4 nocolumn(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, 1.0f, 3.0f);
+	copy = nocolumn;
+	if(nocolumn.InvertScaled() || nocolumn != copy)
+		failures++;
+
+	Test_Report("mat3x4", failures);
+}
+
+static void MatrixBatch_Test1()
+{
+	const int n = 2053;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	mat4x4 *in = new mat4x4[n];
+	mat4x4 *out = new mat4x4[n];
+	mat4x4 *ref = new mat4x4[n];
+	unsigned int *singular = new unsigned int[MATRIXBATCH_MASKWORDS(n)];
+	int numsingular = 0;
+
+	// every 37th matrix has two equal rows
+	for(int i = 0; i < n; i++)
+	{
+		in[i] = Test_RandomMat4x4();
+
+		if(!(i % 37))
+		{
+			in[i].m[2] = in[i].m[1];
+			numsingular++;
+		}
+
+		ref[i] = in[i];
+		ref[i].Invert();
+	}
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+
+		// out of place, then in place on a copy
+		for(int inplace = 0; inplace < 2; inplace++)
+		{
+			int count;
+
+			if(inplace)
+			{
+				memcpy(out, in, n * sizeof(mat4x4));
+				count = MatrixBatch_Invert(out, out, n, singular);
+			}
+			else
+			{
+				count = MatrixBatch_Invert(out, in, n, singular);
+			}
+
+			if(count != numsingular)
+				failures++;
+
+			for(int i = 0; i < n; i++)
+			{
+				bool bit = (singular[i >> 5] >> (i & 31)) & 1;
+
+				if(bit != !(i % 37))
+					failures++;
+
+				// singular ones come back as a copy of the input
+				if(bit)
+					failures += (out[i] != in[i]);
+				else
+					failures += Test_CompareMat4x4(out[i], ref[i], 1e-4f);
+			}
+		}
+	}
+
+	Simd_SetTier(tier);
+
+	delete[] singular;
+	delete[] ref;
+	delete[] out;
+	delete[] in;
+
+	Test_Report("matrixbatch", failures);
+}
+
+static void Mat4x4_Test2()
+{
+	int failures = 0;
+	mat4x4 identity;
+
+	identity.Identity();
+
+	for(int i = 0; i < 1000; i++)
+	{
+		vec3 t(Test_Random() * 10.0f, Test_Random() * 10.0f, Test_Random() * 10.0f);
+		mat4x4 m[4];
+
+		m[MATRIX_GENERAL] = Test_RandomMat4x4();
+		m[MATRIX_AFFINE] = mat3x4(Test_RandomMat4x4()).ToMat4x4();
+		m[MATRIX_RIGID] = mat3x4(Test_RandomRotation(), t).ToMat4x4();
+		m[MATRIX_SCALETRANSLATE] = mat4x4
+		(
+			1.5f + Test_Random(), 0.0f, 0.0f, t.x,
+			0.0f, -1.5f + Test_Random(), 0.0f, t.y,
+			0.0f, 0.0f, 1.5f + Test_Random(), t.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+
+		for(int type = 0; type < 4; type++)
+		{
+			if(m[type].Classify() != type)
+				failures++;
+
+			mat4x4 ref = m[type];
+			if(!ref.Invert())
+				failures++;
+
+			// the specialised path and the automatic one agree with the
+			// general inverse and give an exact affine bottom row
+			mat4x4 inv = m[type];
+			if(!inv.InvertClassified(type))
+				failures++;
+			failures += Test_CompareMat4x4(inv, ref, 1e-4f);
+			failures += Test_CompareMat4x4(m[type] * inv, identity, 1e-5f);
+
+			if(type != MATRIX_GENERAL && inv.m[3] != vec4(0.0f, 0.0f, 0.0f, 1.0f))
+				failures++;
+
+			inv = m[type];
+			if(!inv.InvertAuto())
+				failures++;
+			failures += Test_CompareMat4x4(inv, ref, 1e-4f);
+		}
+
+		// the affine paths also accept the simpler types
+		mat4x4 inv = m[MATRIX_RIGID];
+		if(!inv.InvertAffine())
+			failures++;
+		failures += Test_CompareMat4x4(m[MATRIX_RIGID] * inv, identity, 1e-5f);
+	}
+
+	// a rotation outside MATRIX_RIGID_EPSILON is only affine
+	mat4x4 skew = mat3x4(Test_RandomRotation(), vec3_zero).ToMat4x4();
+	skew.m[0][1] += 0.1f;
+	if(skew.Classify() != MATRIX_AFFINE)
+		failures++;
+
+	// refused inverses leave the matrix alone
+	mat4x4 flat = mat4x4
+	(
+		1.0f, 0.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 0.0f, 2.0f,
+		0.0f, 0.0f, 1.0f, 3.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+	mat4x4 copy = flat;
+
+	if(flat.Classify() != MATRIX_SCALETRANSLATE || flat.InvertAuto() || flat != copy)
+		failures++;
+
+	flat.m[0][1] = 1.0f;
+	copy = flat;
+	if(flat.Classify() != MATRIX_AFFINE || flat.InvertAuto() || flat != copy)
+		failures++;
+
+	Test_Report("mat4x4 classify", failures);
+}
+
+static void MatrixBatch_Test2()
+{
+	const int n = 1029;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	mat4x4 *in4 = new mat4x4[n];
+	mat3x4 *in3 = new mat3x4[n];
+	mat3x3 *out = new mat3x3[n];
+	mat3x3 *ref = new mat3x3[n];
+
+	// every 11th matrix has two equal rows, where InvertTranspose refuses
+	// and the batch gives the cofactors. small scales still invert
+	for(int i = 0; i < n; i++)
+	{
+		in4[i] = Test_RandomMat4x4();
+		if(!(i % 11))
+			in4[i][2] = in4[i][0];
+		else if((i % 11) == 5)
+			in4[i] = in4[i] * 0.01f;
+
+		in3[i] = mat3x4(in4[i]);
+
+		mat3x3 r = in3[i].Rotation();
+		ref[i] = r;
+		if(!ref[i].InvertTranspose())
+		{
+			if(i % 11)
+				failures++;
+			ref[i] = r.Cofactor();
+		}
+	}
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+
+		MatrixBatch_NormalMatrices(out, in4, n);
+		for(int i = 0; i < n; i++)
+			failures += Test_Compare(out[i].Ptr(), ref[i].Ptr(), 9, 1e-4f);
+
+		MatrixBatch_NormalMatrices(out, in3, n);
+		for(int i = 0; i < n; i++)
+			failures += Test_Compare(out[i].Ptr(), ref[i].Ptr(), 9, 1e-4f);
+	}
+
+	Simd_SetTier(tier);
+
+	// a uniform scale of 0.2 has a determinant of 0.008
+	mat3x3 scale(0.2f, 0.0f, 0.0f, 0.0f, 0.2f, 0.0f, 0.0f, 0.0f, 0.2f);
+	mat3x3 inverse = scale;
+	mat3x3 expect(5.0f, 0.0f, 0.0f, 0.0f, 5.0f, 0.0f, 0.0f, 0.0f, 5.0f);
+
+	if(!inverse.Invert())
+		failures++;
+	else
+		failures += Test_Compare(inverse.Ptr(), expect.Ptr(), 9, 1e-5f);
+
+	inverse = scale;
+	if(!inverse.InvertTranspose())
+		failures++;
+	else
+		failures += Test_Compare(inverse.Ptr(), expect.Ptr(), 9, 1e-5f);
+
+	delete[] ref;
+	delete[] out;
+	delete[] in3;
+	delete[] in4;
+
+	Test_Report("matrixbatch normals", failures);
+}
+
+// local matrix as scale, then rotation, then translation
+static mat3x4 Test_LocalMatrix(const vec4& q, const vec3& t, const vec3& s)
+{
+	mat3x3 r = Test_QuatRotation(q);
+
+	for(int i = 0; i < 3; i++)
+	{
+		r[i][0] *= s.x;
+		r[i][1] *= s.y;
+		r[i][2] *= s.z;
+	}
+
+	return mat3x4(r, t);
+}
+
+static int Test_CompareWorld(const hierarchy_t *h, const mat3x4 *local)
+{
+	int failures = 0;
+	mat3x4 *world = new mat3x4[h->numnodes];
+
+	for(int i = 0; i < h->numnodes; i++)
+	{
+		int p = h->parent[i];
+
+		world[i] = (p < 0) ? local[i] : world[p] * local[i];
+		failures += Test_CompareMat3x4(h->world[i], world[i], 1e-4f);
+	}
+
+	delete[] world;
+
+	return failures;
+}
+
+static void Hierarchy_Test1()
+{
+	const int sizes[2] = { 301, 5003 };
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	// one hierarchy under the serial threshold, one updated level by level
+	for(int k = 0; k < 2; k++)
+	{
+		int n = sizes[k];
+		hierarchy_t *h = Hierarchy_Alloc(n);
+		mat3x4 *local = new mat3x4[n];
+
+		for(int i = 0; i < n; i++)
+		{
+			int parent = (i < 4) ? -1 : (rand() % i);
+			int node = Hierarchy_AddNode(h, parent);
+
+			if(node != i || h->depth[i] != ((parent < 0) ? 0 : h->depth[parent] + 1))
+				failures++;
+
+			vec4 q = Test_RandomQuat();
+			vec3 t(Test_Random(), Test_Random(), Test_Random());
+			vec3 s(1.0f + Test_Random() * 0.25f, 1.0f + Test_Random() * 0.25f, 1.0f + Test_Random() * 0.25f);
+
+			Hierarchy_SetLocal(h, i, q, t, s);
+			local[i] = Test_LocalMatrix(q, t, s);
+		}
+
+		for(int t = 0; t <= Simd_SupportedTier(); t++)
+		{
+			Simd_SetTier(t);
+			Hierarchy_Update(h);
+
+			for(int i = 0; i < n; i++)
+				failures += Test_CompareMat3x4(h->local[i], local[i], 1e-5f);
+
+			failures += Test_CompareWorld(h, local);
+		}
+
+		// a partial update only has to reach the moved nodes and their
+		// descendants, and leaves nothing dirty behind
+		for(int j = 0; j < 20; j++)
+		{
+			int i = rand() % n;
+			vec4 q = Test_RandomQuat();
+			vec3 t(Test_Random(), Test_Random(), Test_Random());
+			vec3 s(1.0f, 2.0f, 0.5f);
+
+			Hierarchy_SetLocal(h, i, q, t, s);
+			local[i] = Test_LocalMatrix(q, t, s);
+		}
+
+		Hierarchy_UpdateDirty(h);
+		failures += Test_CompareWorld(h, local);
+
+		for(int i = 0; i < ((n + 31) >> 5); i++)
+		{
+			if(h->dirty[i] || h->changed[i])
+				failures++;
+		}
+
+		delete[] local;
+		Hierarchy_Free(h);
+	}
+
+	Simd_SetTier(tier);
+
+	Test_Report("hierarchy", failures);
+}
+
+// plane by plane reference for the frustum kernels. a box is bmin and bmax,
+// a sphere is its center and a radius in r.x
+static bool Test_FrustumRejects(const plane_t &p, const vec3& a, const vec3& r, bool box)
+{
+	if(box)
+	{
+		vec3 corner((p.a >= 0.0f) ? r.x : a.x, (p.b >= 0.0f) ? r.y : a.y, (p.c >= 0.0f) ? r.z : a.z);
+		return (p.a * corner.x + p.b * corner.y + p.c * corner.z + p.d) < 0.0f;
+	}
+
+	return (p.a * a.x + p.b * a.y + p.c * a.z + p.d) < -r.x;
+}
+
+static void Frustum_Test1()
+{
+	const int n = 10007;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	bounds_soa *boxes = Bounds_Alloc(n);
+	vec3_soa *centers = Vec3SoA_Alloc(n);
+	float *radii = new float[n];
+	vec3 *lo[2] = { new vec3[n], new vec3[n] };
+	vec3 *hi[2] = { new vec3[n], new vec3[n] };
+	bool *inside[2] = { new bool[n], new bool[n] };
+	unsigned int *visible = new unsigned int[FRUSTUM_MASKWORDS(n)];
+	unsigned char *hints = new unsigned char[n];
+	frustum_t f;
+
+	// a cube from -2 to 2 on every axis, rotated
+	mat3x3 scale(0.5f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 0.5f);
+	Frustum_FromMatrix(&f, mat3x4(Test_RandomRotation() * scale, vec3_zero).ToMat4x4());
+
+	boxes->numboxes = n;
+	centers->numvectors = n;
+	for(int i = 0; i < n; i++)
+	{
+		vec3 c(Test_Random() * 4.0f, Test_Random() * 4.0f, Test_Random() * 4.0f);
+		vec3 e(fabsf(Test_Random()) * 0.5f, fabsf(Test_Random()) * 0.5f, fabsf(Test_Random()) * 0.5f);
+
+		Bounds_Set(boxes, i, c - e, c + e);
+		centers->x[i] = c.x;
+		centers->y[i] = c.y;
+		centers->z[i] = c.z;
+		radii[i] = e.x;
+
+		// spheres in slot 0, boxes in slot 1
+		lo[0][i] = c;
+		hi[0][i] = vec3(e.x, 0.0f, 0.0f);
+		lo[1][i] = c - e;
+		hi[1][i] = c + e;
+
+		for(int box = 0; box < 2; box++)
+		{
+			inside[box][i] = true;
+			for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+			{
+				if(Test_FrustumRejects(f.planes[k], lo[box][i], hi[box][i], box != 0))
+					inside[box][i] = false;
+			}
+		}
+	}
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+
+		for(int box = 0; box < 2; box++)
+		{
+			// no hints, fresh hints, the hints from the call before and
+			// random stale hints must all give the same mask
+			for(int pass = 0; pass < 4; pass++)
+			{
+				unsigned char *h = pass ? hints : NULL;
+				int numvisible, count = 0;
+
+				if(pass == 1)
+				{
+					memset(hints, FRUSTUM_NOHINT, n);
+				}
+				else if(pass == 3)
+				{
+					for(int i = 0; i < n; i++)
+						hints[i] = (unsigned char)(rand() % (FRUSTUM_NUMPLANES + 1));
+				}
+
+				if(box)
+					numvisible = Frustum_CullBounds(&f, boxes, visible, h);
+				else
+					numvisible = Frustum_CullSpheres(&f, centers, radii, visible, h);
+
+				for(int i = 0; i < n; i++)
+				{
+					bool bit = (visible[i >> 5] >> (i & 31)) & 1;
+
+					if(bit != inside[box][i])
+						failures++;
+
+					count += inside[box][i];
+
+					if(!h)
+						continue;
+
+					// visible objects lose their hint, culled ones name a
+					// plane that rejects them
+					if(inside[box][i])
+						failures += (h[i] != FRUSTUM_NOHINT);
+					else if(h[i] >= FRUSTUM_NUMPLANES || !Test_FrustumRejects(f.planes[h[i]], lo[box][i], hi[box][i], box != 0))
+						failures++;
+				}
+
+				if(numvisible != count)
+					failures++;
+			}
+		}
+	}
+
+	// every rejection is credited to exactly one plane
+	int culled = Frustum_CullBounds(&f, boxes, visible, hints);
+	for(int k = 0; k < FRUSTUM_NUMPLANES; k++)
+		culled += f.culled[k];
+	if(culled != n)
+		failures++;
+
+	Simd_SetTier(tier);
+
+	delete[] hints;
+	delete[] visible;
+	for(int box = 0; box < 2; box++)
+	{
+		delete[] inside[box];
+		delete[] hi[box];
+		delete[] lo[box];
+	}
+	delete[] radii;
+	Vec3SoA_Free(centers);
+	Bounds_Free(boxes);
+
+	Test_Report("frustum", failures);
+}
+
+static void Plane_Test1()
+{
+	const int n = 1037;
+	const float epsilon = PLANE_DEFAULT_EPSILON;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	vec3 *points = new vec3[n];
+	float *refdists = new float[n];
+	int *refsides = new int[n];
+	float *dists = new float[n];
+	unsigned int *sides = new unsigned int[PLANE_SIDE_WORDS(n)];
+	vec3_soa *soa = Vec3SoA_Alloc(n);
+	int refcounts[3] = { 0, 0, 0 };
+
+	plane_t p(Test_Random(), Test_Random(), Test_Random() + 2.0f, 0.0f);
+	p.Normalize();
+	p.d = 0.25f;
+
+	for(int i = 0; i < n; i++)
+	{
+		points[i] = vec3(Test_Random(), Test_Random(), Test_Random());
+
+		// every tenth point exactly on the plane, none within rounding of
+		// the epsilon where fused multiplies could flip the side
+		if(!(i % 10))
+			points[i] = points[i] - p.Normal() * p.Distance(points[i]);
+
+		float d = p.Distance(points[i]);
+		if(fabsf(fabsf(d) - epsilon) < 1e-3f)
+			points[i] = points[i] + p.Normal() * 0.01f;
+
+		refdists[i] = p.Distance(points[i]);
+		refsides[i] = p.Side(points[i], epsilon);
+		refcounts[refsides[i]]++;
+	}
+
+	Vec3SoA_FromVec3(soa, points, n);
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+
+		for(int layout = 0; layout < 2; layout++)
+		{
+			int counts[3];
+
+			if(layout)
+				Plane_ClassifySoA(p, soa, epsilon, dists, sides, counts);
+			else
+				Plane_ClassifyPoints(p, points, n, epsilon, dists, sides, counts);
+
+			failures += Test_Compare(dists, refdists, n, 1e-5f);
+
+			for(int i = 0; i < n; i++)
+				failures += (PLANE_SIDE_GET(sides, i) != (unsigned int)refsides[i]);
+
+			for(int s = 0; s < 3; s++)
+				failures += (counts[s] != refcounts[s]);
+		}
+	}
+
+	Simd_SetTier(tier);
+
+	// axial types and sign bits follow the normal
+	plane_t axial(0.0f, -1.0f, 0.0f, 3.0f);
+	if(axial.type != PLANE_Y || axial.signbits != 2)
+		failures++;
+
+	axial.Reverse();
+	if(axial.type != PLANE_Y || axial.signbits != 0 || axial.d != -3.0f)
+		failures++;
+
+	if(p.type != PLANE_NONAXIAL || Plane_TypeForNormal(0.0f, 0.0f, 1.0f) != PLANE_Z)
+		failures++;
+
+	Vec3SoA_Free(soa);
+	delete[] sides;
+	delete[] dists;
+	delete[] refsides;
+	delete[] refdists;
+	delete[] points;
+
+	Test_Report("plane classify", failures);
+}
+
+static void PlaneSet_Test1()
+{
+	const int n = 2051;
+	const int numplanes = 13;
+	const float epsilon = 0.01f;
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	plane_t planes[numplanes];
+	vec3 *points = new vec3[n];
+	float *refdists = new float[n];
+	unsigned int *inside = new unsigned int[PLANESET_MASKWORDS(n)];
+	vec3_soa *soa = Vec3SoA_Alloc(n);
+
+	// planes one unit from the origin facing it, more than a register of
+	// them so the padding slots are used
+	for(int k = 0; k < numplanes; k++)
+	{
+		planes[k] = plane_t(Test_Random(), Test_Random(), Test_Random(), 0.0f);
+		planes[k].Normalize();
+		planes[k].d = 1.0f;
+	}
+
+	plane_set *s = PlaneSet_Alloc(numplanes);
+	PlaneSet_FromPlanes(s, planes, numplanes);
+
+	for(int i = 0; i < n; i++)
+	{
+		points[i] = vec3(Test_Random(), Test_Random(), Test_Random()) * 2.0f;
+
+		refdists[i] = 1e20f;
+		for(int k = 0; k < numplanes; k++)
+		{
+			float d = planes[k].Distance(points[i]);
+			refdists[i] = (d < refdists[i]) ? d : refdists[i];
+		}
+	}
+
+	Vec3SoA_FromVec3(soa, points, n);
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+
+		for(int layout = 0; layout < 2; layout++)
+		{
+			int count = layout ? PlaneSet_ContainsSoA(s, soa, epsilon, inside) : PlaneSet_ContainsPoints(s, points, n, epsilon, inside);
+			int refcount = 0;
+
+			for(int i = 0; i < n; i++)
+			{
+				bool in = refdists[i] >= -epsilon;
+				bool bit = (inside[i >> 5] >> (i & 31)) & 1;
+
+				refcount += in;
+
+				// leave the answer open within rounding of the boundary
+				if(fabsf(refdists[i] + epsilon) > 1e-4f && bit != in)
+					failures++;
+			}
+
+			if(count != refcount)
+				failures++;
+		}
+
+		// single queries, spheres and boxes against the same distances
+		for(int i = 0; i < 200; i++)
+		{
+			float d = PlaneSet_MinDistance(s, points[i]);
+			float r = fabsf(Test_Random()) * 0.5f;
+
+			failures += Test_Compare(&d, &refdists[i], 1, 1e-5f);
+
+			if(fabsf(refdists[i] + epsilon) > 1e-4f && PlaneSet_ContainsPoint(s, points[i], epsilon) != (refdists[i] >= -epsilon))
+				failures++;
+
+			if(fabsf(fabsf(refdists[i]) - r) > 1e-4f)
+			{
+				int expect = (refdists[i] < -r) ? PLANESET_OUTSIDE : ((refdists[i] >= r) ? PLANESET_INSIDE : PLANESET_INTERSECT);
+
+				if(PlaneSet_ClassifySphere(s, points[i], r) != expect)
+					failures++;
+			}
+
+			// a box fully inside or outside by a margin from its corners
+			vec3 e(r, r, r);
+			float nearest = 1e20f, farthest = -1e20f;
+
+			for(int c = 0; c < 8; c++)
+			{
+				vec3 corner = points[i] + vec3((c & 1) ? r : -r, (c & 2) ? r : -r, (c & 4) ? r : -r);
+				float md = 1e20f;
+
+				for(int k = 0; k < numplanes; k++)
+				{
+					float pd = planes[k].Distance(corner);
+					md = (pd < md) ? pd : md;
+				}
+
+				nearest = (md < nearest) ? md : nearest;
+				farthest = (md > farthest) ? md : farthest;
+			}
+
+			int box = PlaneSet_ClassifyBox(s, points[i] - e, points[i] + e);
+
+			if(nearest > 1e-4f && box != PLANESET_INSIDE)
+				failures++;
+			if(box == PLANESET_INSIDE && nearest < -1e-4f)
+				failures++;
+			if(box == PLANESET_OUTSIDE && farthest > 1e-4f)
+				failures++;
+		}
+	}
+
+	Simd_SetTier(tier);
+
+	PlaneSet_Free(s);
+	Vec3SoA_Free(soa);
+	delete[] inside;
+	delete[] refdists;
+	delete[] points;
+
+	Test_Report("planeset", failures);
+}
+
+static void PlanePool_Test1()
+{
+	const int n = 500;
+	int failures = 0;
+
+	planepool_t *pool = PlanePool_Alloc(2 * n);
+	plane_t *planes = new plane_t[n];
+	int *index = new int[n];
+
+	for(int i = 0; i < n; i++)
+	{
+		planes[i] = plane_t(Test_Random(), Test_Random(), Test_Random(), 0.0f);
+		planes[i].Normalize();
+		// fractions from 0.25 to 0.75 so neither d nor the near copy
+		// below is snapped to a whole number
+		planes[i].d = floorf(Test_Random() * 100.0f) + 0.5f + Test_Random() * 0.25f;
+
+		index[i] = PlanePool_FindPlane(pool, planes[i]);
+		if(index[i] < 0)
+			failures++;
+	}
+
+	for(int i = 0; i < n; i++)
+	{
+		const plane_t &p = PlanePool_Plane(pool, index[i]);
+		const plane_t &r = PlanePool_Plane(pool, PLANEPOOL_OPPOSITE(index[i]));
+
+		// stored as given, with the reverse next to it and the positive
+		// facing plane in the even slot
+		if(p.a != planes[i].a || p.d != planes[i].d || r.a != -p.a || r.d != -p.d)
+			failures++;
+
+		const plane_t &even = PlanePool_Plane(pool, index[i] & ~1);
+		if(even.a <= 0.0f && !(even.a == 0.0f && even.b > 0.0f))
+			failures++;
+
+		// exact and near duplicates find the same plane, the reverse finds
+		// the opposite
+		plane_t near = planes[i];
+		near.a += 2e-6f;
+		near.d += 0.004f;
+
+		plane_t reversed = planes[i];
+		reversed.Reverse();
+
+		if(PlanePool_FindPlane(pool, planes[i]) != index[i] ||
+			PlanePool_FindPlane(pool, near) != index[i] ||
+			PlanePool_FindPlane(pool, reversed) != PLANEPOOL_OPPOSITE(index[i]))
+			failures++;
+	}
+
+	// nothing new was added by the lookups
+	if(pool->numplanes != 2 * n)
+		failures++;
+
+	// full pool
+	plane_t extra(0.0f, 0.6f, 0.8f, 1234.5f);
+	if(PlanePool_FindPlane(pool, extra) != -1)
+		failures++;
+
+	// near axial normals and near integer distances snap
+	PlanePool_Clear(pool);
+
+	plane_t axial(0.000001f, -0.999999f, 0.0f, 7.003f);
+	int a = PlanePool_FindPlane(pool, axial);
+	const plane_t &snapped = PlanePool_Plane(pool, a);
+
+	if(a != 1 || snapped.b != -1.0f || snapped.a != 0.0f || snapped.d != 7.0f || PlanePool_Type(pool, a) != PLANE_Y)
+		failures++;
+
+	if(PlanePool_Plane(pool, 0).b != 1.0f || PlanePool_Plane(pool, 0).d != -7.0f)
+		failures++;
+
+	// a different distance is a different plane
+	axial.d = 7.5f;
+	if(PlanePool_FindPlane(pool, axial) != 3 || pool->numplanes != 4)
+		failures++;
+
+	// distances past INT_MAX hash and match like any other
+	plane_t far(0.0f, 0.6f, 0.8f, 3.0e9f);
+	plane_t farther(0.6f, 0.0f, 0.8f, -1.0e20f);
+	int f0 = PlanePool_FindPlane(pool, far);
+	int f1 = PlanePool_FindPlane(pool, farther);
+
+	if(f0 < 0 || f1 < 0 || f0 == f1 || PlanePool_FindPlane(pool, far) != f0 || PlanePool_FindPlane(pool, farther) != f1 || pool->numplanes != 8)
+		failures++;
+
+	delete[] index;
+	delete[] planes;
+	PlanePool_Free(pool);
+
+	Test_Report("planepool", failures);
+}
+
+static void RayPacket_Test1()
+{
+	const int n = 1031;
+	const int sizes[3] = { 4, 40, 100 };
+	int failures = 0;
+	int tier = Simd_GetTier();
+
+	vec3_soa *origins = Vec3SoA_Alloc(n);
+	vec3_soa *dirs = Vec3SoA_Alloc(n);
+	vec3 *o = new vec3[n];
+	vec3 *dir = new vec3[n];
+	float *fractions = new float[n];
+	unsigned int *hits = new unsigned int[RAYPACKET_MASKWORDS(n)];
+
+	// rays from above aimed around the unit disc at z = 0.5, every tenth
+	// pointing away and every seventeenth parallel to it
+	for(int i = 0; i < n; i++)
+	{
+		o[i] = vec3(Test_Random(), Test_Random(), 2.0f + Test_Random() * 0.5f);
+		vec3 target(Test_Random() * 1.5f, Test_Random() * 1.5f, 0.5f);
+
+		dir[i] = target - o[i];
+		if(!(i % 10))
+			dir[i] = -dir[i];
+		if(!(i % 17))
+			dir[i].z = 0.0f;
+	}
+
+	Vec3SoA_FromVec3(origins, o, n);
+	Vec3SoA_FromVec3(dirs, dir, n);
+
+	// regular polygons wound counterclockwise about +z, the largest past
+	// the stack edge buffer
+	for(int k = 0; k < 3; k++)
+	{
+		int numvertices = sizes[k];
+		polygon_t *p = Polygon_Alloc(numvertices);
+
+		p->numvertices = numvertices;
+		for(int j = 0; j < numvertices; j++)
+		{
+			float a = (2.0f * 3.14159265f * j) / numvertices;
+			p->vertices[j] = vec3(cosf(a), sinf(a), 0.5f);
+		}
+
+		for(int t = 0; t <= Simd_SupportedTier(); t++)
+		{
+			Simd_SetTier(t);
+
+			int numhits = RayPacket_IntersectPolygon(p, origins, dirs, fractions, hits);
+			int count = 0;
+
+			for(int i = 0; i < n; i++)
+			{
+				float f;
+				bool ref = Polygon_RayIntersection(p, o[i], dir[i], &f);
+				bool bit = (hits[i >> 5] >> (i & 31)) & 1;
+
+				count += bit;
+
+				// leave hits within rounding of an edge open
+				if(dir[i].z != 0.0f)
+				{
+					vec3 h = o[i] + (-(o[i].z - 0.5f) / dir[i].z) * dir[i];
+					float edgedist = 1e20f;
+
+					for(int j = 0; j < numvertices; j++)
+					{
+						vec3 v0 = p->vertices[j];
+						vec3 v1 = p->vertices[(j + 1) % numvertices];
+						float d = fabsf(Dot(Normalize(Cross(vec3(0.0f, 0.0f, 1.0f), v1 - v0)), h - v0));
+
+						edgedist = (d < edgedist) ? d : edgedist;
+					}
+
+					if(edgedist < 1e-4f)
+						continue;
+				}
+
+				if(bit != ref)
+					failures++;
+				else if(ref)
+					failures += Test_Compare(&fractions[i], &f, 1, 1e-5f);
+				else if(fractions[i] != RAYPACKET_MISS)
+					failures++;
+			}
+
+			if(numhits != count)
+				failures++;
+		}
+
+		Polygon_Free(p);
+	}
+
+	// a bare plane agrees with plane_t::RayIntersection
+	plane_t plane(0.0f, 0.0f, 1.0f, -0.5f);
+
+	for(int t = 0; t <= Simd_SupportedTier(); t++)
+	{
+		Simd_SetTier(t);
+		RayPacket_IntersectPlane(plane, origins, dirs, fractions, hits);
+
+		for(int i = 0; i < n; i++)
+		{
+			float f;
+			bool ref = plane.RayIntersection(o[i], dir[i], &f);
+
+			if(((hits[i >> 5] >> (i & 31)) & 1) != (unsigned int)ref)
+				failures++;
+			else if(ref)
+				failures += Test_Compare(&fractions[i], &f, 1, 1e-5f);
+		}
+	}
+
+	Simd_SetTier(tier);
+
+	delete[] hits;
+	delete[] fractions;
+	delete[] dir;
+	delete[] o;
+	Vec3SoA_Free(dirs);
+	Vec3SoA_Free(origins);
+
+	Test_Report("raypacket", failures);
+}
+
+static int Test_ArenaBlocks(const arena_t *a)
+{
+	int count = 0;
+
+	for(arena_block_t *b = a->first; b; b = b->next)
+		count++;
+
+	return count;
+}
+
+static void Arena_Test1()
+{
+	int failures = 0;
+	arena_t *a = Arena_Alloc(1024);
+
+	// pushes are aligned and packed
+	char *p0 = (char*)Arena_Push(a, 1);
+	char *p1 = (char*)Arena_Push(a, 17);
+	char *p2 = (char*)Arena_Push(a, 16);
+
+	if(((size_t)p0 & (ARENA_ALIGN - 1)) || p1 != p0 + ARENA_ALIGN || p2 != p1 + (2 * ARENA_ALIGN))
+		failures++;
+
+	// a release hands the same memory out again, across block boundaries
+	arena_mark_t mark = Arena_Mark(a);
+	char *first = (char*)Arena_Push(a, 100);
+	for(int i = 0; i < 50; i++)
+		Arena_Push(a, 100);
+
+	int numblocks = Test_ArenaBlocks(a);
+	if(numblocks < 5)
+		failures++;
+
+	Arena_Release(a, mark);
+	if(Arena_Push(a, 100) != first)
+		failures++;
+
+	// the kept blocks cover the same pushes again without growing
+	for(int i = 0; i < 50; i++)
+		Arena_Push(a, 100);
+	if(Test_ArenaBlocks(a) != numblocks)
+		failures++;
+
+	// a request over the block size gets a block of its own
+	char *big = (char*)Arena_Push(a, 5000);
+	big[4999] = 1;
+	if(a->current->size < 5000)
+		failures++;
+
+	// scopes nest and rewind on exit
+	Arena_Reset(a);
+	if(Arena_Push(a, 1) != p0)
+		failures++;
+	{
+		arena_scope_t outer(a);
+		void *q = Arena_Push(a, 64);
+		{
+			arena_scope_t inner(a);
+			Arena_Push(a, 2000);
+		}
+		if(Arena_Push(a, 16) != (char*)q + 64)
+			failures++;
+	}
+	if(Arena_Push(a, 16) != p0 + ARENA_ALIGN)
+		failures++;
+
+	// the callbacks and allocator_t push on the current arena
+	arena_t *b = Arena_Alloc(1024);
+	allocator_t alloc;
+
+	Arena_SetShared(a);
+	Arena_SetThread(b);
+	if(Arena_Current() != b)
+		failures++;
+
+	mark = Arena_Mark(b);
+	void *m = Arena_MemAlloc(32);
+	Arena_MemFree(m);
+	if(Arena_Mark(b).used != mark.used + 32)
+		failures++;
+
+	Arena_SetThread(NULL);
+	if(Arena_Current() != a)
+		failures++;
+
+	Arena_InitAllocator(&alloc, b);
+	mark = Arena_Mark(b);
+	void *n = alloc.alloc(alloc.context, 48);
+	alloc.free(alloc.context, n);
+	if(Arena_Mark(b).used != mark.used + 48)
+		failures++;
+
+	Arena_Release(b, mark);
+	if(alloc.alloc(alloc.context, 48) != n)
+		failures++;
+
+	Arena_SetShared(NULL);
+	Arena_Free(b);
+	Arena_Free(a);
+
+	Test_Report("arena", failures);
+}
+
+#define POLYPOOL_TEST_THREADS	8
+#define POLYPOOL_TEST_BLOCKS	4000
+
+typedef struct polypool_test_s
+{
+	// each thread frees the handoff blocks of the thread before it
+	void			*handoff[POLYPOOL_TEST_THREADS][POLYPOOL_TEST_BLOCKS];
+	int			sizes[POLYPOOL_TEST_THREADS][POLYPOOL_TEST_BLOCKS];
+	std::atomic<int>	ready;
+	std::atomic<int>	corrupt;
+	std::atomic<long long>	pooled;
+	std::atomic<long long>	oversize;
+
+} polypool_test_t;
+
+static void PolyPool_TestThread(polypool_test_t *test, int id)
+{
+	unsigned int seed = 12345u + id;
+	void *local[64];
+	int localsizes[64];
+	long long pooled = 0, oversize = 0;
+
+	for(int i = 0; i < POLYPOOL_TEST_BLOCKS; i++)
+	{
+		// every class and some oversize requests, filled with the owner
+		for(int k = 0; k < 2; k++)
+		{
+			seed = seed * 1103515245u + 12345u;
+			int numbytes = 8 + (int)((seed >> 8) % (unsigned int)Polygon_MemSize(72));
+			unsigned char *p = (unsigned char*)PolyPool_MemAlloc(numbytes);
+
+			memset(p, id, numbytes);
+			(numbytes > Polygon_MemSize(64)) ? oversize++ : pooled++;
+
+			if(k)
+			{
+				test->handoff[id][i] = p;
+				test->sizes[id][i] = numbytes;
+			}
+			else
+			{
+				local[i & 63] = p;
+				localsizes[i & 63] = numbytes;
+			}
+		}
+
+		// local frees in batches, so the caches fill and spill
+		if((i & 63) == 63)
+		{
+			for(int j = 0; j < 64; j++)
+			{
+				unsigned char *p = (unsigned char*)local[j];
+
+				if(p[0] != id || p[localsizes[j] - 1] != id)
+					test->corrupt++;
+				PolyPool_MemFree(p);
+			}
+		}
+	}
+
+	for(int j = 0; j < (POLYPOOL_TEST_BLOCKS & 63); j++)
+		PolyPool_MemFree(local[j]);
+
+	// wait for everyone, then free the neighbour's blocks
+	test->ready++;
+	while(test->ready.load() < POLYPOOL_TEST_THREADS)
+		;
+
+	int from = (id + POLYPOOL_TEST_THREADS - 1) % POLYPOOL_TEST_THREADS;
+	for(int i = 0; i < POLYPOOL_TEST_BLOCKS; i++)
+	{
+		unsigned char *p = (unsigned char*)test->handoff[from][i];
+
+		if(p[0] != from || p[test->sizes[from][i] - 1] != from)
+			test->corrupt++;
+		PolyPool_MemFree(p);
+	}
+
+	test->pooled += pooled;
+	test->oversize += oversize;
+}
+
+static void PolyPool_Test1()
+{
+	int failures = 0;
+	polypool_test_t *test = new polypool_test_t;
+	polypool_stats_t stats;
+
+	// settle the counts this thread has cached so far
+	PolyPool_FlushThreadCache();
+
+	// once with thread caches, once switching them on and off underneath
+	for(int pass = 0; pass < 2; pass++)
+	{
+		std::thread threads[POLYPOOL_TEST_THREADS];
+
+		test->ready = 0;
+		test->corrupt = 0;
+		test->pooled = 0;
+		test->oversize = 0;
+
+		PolyPool_ResetStats();
+
+		for(int i = 0; i < POLYPOOL_TEST_THREADS; i++)
+			threads[i] = std::thread(PolyPool_TestThread, test, i);
+
+		for(int i = 0; pass && test->ready.load() < POLYPOOL_TEST_THREADS; i++)
+			PolyPool_SetThreadCaches(i & 1);
+
+		for(int i = 0; i < POLYPOOL_TEST_THREADS; i++)
+			threads[i].join();
+
+		PolyPool_SetThreadCaches(true);
+
+		// exiting threads flush their counts, so the totals are exact
+		PolyPool_GetStats(&stats);
+
+		if(test->corrupt)
+			failures++;
+		if(stats.hits + stats.misses != test->pooled || stats.oversize != test->oversize)
+			failures++;
+		// freed blocks are reused, the second pass may need no new slabs
+		if(stats.hits <= stats.misses)
+			failures++;
+	}
+
+	delete test;
+
+	Test_Report("polypool", failures);
+}
+
+// counts the live allocations made through it
+typedef struct testallocator_s
+{
+	allocator_t		a;
+	std::atomic<int>	live;
+
+} testallocator_t;
+
+static void *Test_AllocatorAlloc(void *context, int numbytes)
+{
+	((testallocator_t*)context)->live++;
+	return malloc(numbytes);
+}
+
+static void Test_AllocatorFree(void *context, void *p)
+{
+	((testallocator_t*)context)->live--;
+	free(p);
+}
+
+static void Test_InitAllocator(testallocator_t *t)
+{
+	t->a.alloc = Test_AllocatorAlloc;
+	t->a.free = Test_AllocatorFree;
+	t->a.context = t;
+	t->live = 0;
+}
+
+static std::atomic<int> test_callbacklive(0);
+
+static void *Test_CallbackAlloc(int numbytes)
+{
+	test_callbacklive++;
+	return malloc(numbytes);
+}
+
+static void Test_CallbackFree(void *p)
+{
+	test_callbacklive--;
+	free(p);
+}
+
+static void Allocator_TestThread(polygon_t *p0, int *failures)
+{
+	if(Allocator_Thread())
+		(*failures)++;
+
+	polygon_t *p = Polygon_Alloc(4);
+	Polygon_Free(p0);
+	Polygon_Free(p);
+}
+
+static void Allocator_Test1()
+{
+	int failures = 0;
+	testallocator_t global, bound;
+
+	Test_InitAllocator(&global);
+	Test_InitAllocator(&bound);
+
+	if(Allocator_Current() != Allocator_Default() || Allocator_Thread())
+		failures++;
+
+	// polygons and volumes take the same order: thread, then global
+	Allocator_SetGlobal(&global.a);
+	polygon_t *p0 = Polygon_Alloc(8);
+	volume_t *v0 = Volume_Alloc(4);
+
+	Allocator_SetThread(&bound.a);
+	polygon_t *p1 = Polygon_Alloc(8);
+	volume_t *v1 = Volume_Alloc(4);
+
+	if(p0->allocator != &global.a || v0->allocator != &global.a || global.live != 2)
+		failures++;
+	if(p1->allocator != &bound.a || v1->allocator != &bound.a || bound.live != 2)
+		failures++;
+
+	// the callbacks replace the global allocator, not the thread's
+	Polygon_SetMemCallbacks(Test_CallbackAlloc, Test_CallbackFree);
+
+	polygon_t *p2 = Polygon_Alloc(8);
+	if(p2->allocator != &bound.a)
+		failures++;
+
+	Allocator_SetThread(NULL);
+
+	polygon_t *p3 = Polygon_Alloc(8);
+	volume_t *v3 = Volume_Alloc(4);
+	if(test_callbacklive != 2 || p3->allocator != v3->allocator || p3->allocator == &global.a)
+		failures++;
+
+	// another thread sees the global allocator and frees go back to
+	// where each object came from
+	std::thread other(Allocator_TestThread, p0, &failures);
+	other.join();
+
+	Polygon_SetMemCallbacks(NULL, NULL);
+	if(Allocator_Current() != Allocator_Default())
+		failures++;
+
+	Polygon_Free(p3);
+	Volume_Free(v3);
+	Polygon_Free(p2);
+	Polygon_Free(p1);
+	Volume_Free(v1);
+	Volume_Free(v0);
+
+	if(global.live || bound.live || test_callbacklive)
+		failures++;
+
+	Test_Report("allocator", failures);
+}
+
+// regular polygon in the z = 0 plane, wound about +z
+static polygon_t* Test_RegularPolygon(int numvertices, float radius)
+{
+	polygon_t* p = Polygon_Alloc(numvertices);
+
+	p->numvertices = numvertices;
+	for(int i = 0; i < numvertices; i++)
+	{
+		float a = (2.0f * 3.14159265f * (i + 0.5f)) / numvertices;
+		p->vertices[i] = vec3(radius * cosf(a), radius * sinf(a), 0.0f);
+	}
+
+	return p;
+}
+
+static int Test_CheckSide(polygon_t* p, const vec3& normal, float dist, float epsilon, float sign)
+{
+	int failures = 0;
+
+	for(int i = 0; i < p->numvertices; i++)
+	{
+		if(sign * (Dot(p->vertices[i], normal) - dist) < -epsilon)
+			failures++;
+	}
+
+	return failures;
+}
+
+static void Polygon_Test9()
+{
+	const int sizes[5] = { 8, 32, 33, 64, 200 };
+	const float epsilon = 0.001f;
+	int failures = 0;
+
+	// around the stack distance buffer and well past it
+	for(int k = 0; k < 5; k++)
+	{
+		int numvertices = sizes[k];
+		polygon_t* in = Test_RegularPolygon(numvertices, 10.0f);
+		float area = Polygon_Area(in);
+
+		for(int j = 0; j < 20; j++)
+		{
+			vec3 normal = Normalize(vec3(Test_Random(), Test_Random(), Test_Random() * 0.1f));
+			float dist = Test_Random() * 5.0f;
+			polygon_t* front;
+			polygon_t* back;
+
+			Polygon_SplitWithPlane(in, normal, dist, epsilon, &front, &back);
+
+			if(!front || !back)
+			{
+				failures++;
+				continue;
+			}
+
+			// a crossing adds two points to each side, less any that land
+			// on the plane
+			if(front->numvertices + back->numvertices > numvertices + 4 ||
+				front->numvertices + back->numvertices < numvertices + 2)
+				failures++;
+
+			failures += Test_CheckSide(front, normal, dist, epsilon, 1.0f);
+			failures += Test_CheckSide(back, normal, dist, epsilon, -1.0f);
+
+			float sum = Polygon_Area(front) + Polygon_Area(back);
+			failures += Test_Compare(&sum, &area, 1, 1e-4f);
+
+			// clipping gives the same front without building the back
+			polygon_t* clip = Polygon_Alloc(POLYGON_SPLIT_VERTICES(numvertices));
+
+			if(Polygon_SplitInto(in, normal, dist, epsilon, clip, NULL) != POLYGON_SIDE_CROSS || clip->numvertices != front->numvertices)
+				failures++;
+			else
+				failures += Test_CompareVec3(clip->vertices, front->vertices, clip->numvertices, 0.0f);
+
+			Polygon_Free(clip);
+			Polygon_Free(front);
+			Polygon_Free(back);
+		}
+
+		// planes that miss the polygon keep it whole on one side, and only
+		// the copy is allocated
+		testallocator_t counter;
+		polygon_t* front;
+		polygon_t* back;
+
+		Test_InitAllocator(&counter);
+		Allocator_SetThread(&counter.a);
+
+		Polygon_SplitWithPlane(in, vec3(1.0f, 0.0f, 0.0f), -20.0f, epsilon, &front, &back);
+		if(!front || back || front->numvertices != numvertices || front->maxvertices != in->maxvertices || counter.live != 1)
+			failures++;
+		else
+			failures += Test_CompareVec3(front->vertices, in->vertices, numvertices, 0.0f);
+		if(front)
+			Polygon_Free(front);
+
+		Polygon_SplitWithPlane(in, vec3(1.0f, 0.0f, 0.0f), 20.0f, epsilon, &front, &back);
+		if(front || !back || back->numvertices != numvertices || back->maxvertices != in->maxvertices || counter.live != 1)
+			failures++;
+		if(back)
+			Polygon_Free(back);
+
+		// in its own plane
+		Polygon_SplitWithPlane(in, vec3(0.0f, 0.0f, 1.0f), 0.0f, epsilon, &front, &back);
+		if(front || back || counter.live != 0)
+			failures++;
+
+		Allocator_SetThread(NULL);
+		Polygon_Free(in);
+	}
+
+	Test_Report("polygon split", failures);
+}
+
+static void PolyPool_Test2()
+{
+	const int numblocks = POLYPOOL_CACHE_MAX + 1;
+	void *blocks[numblocks];
+	int failures = 0;
+
+	for(int i = 0; i < numblocks; i++)
+		blocks[i] = PolyPool_MemAlloc(Polygon_MemSize(4));
+
+	// start from an empty cache, so the last free is the one that spills
+	PolyPool_FlushThreadCache();
+
+	for(int i = 0; i < numblocks; i++)
+		PolyPool_MemFree(blocks[i]);
+
+	// the first frees went to the global pool, the rest come back newest first
+	for(int i = numblocks - 1; i >= POLYPOOL_BATCH; i--)
+	{
+		if(PolyPool_MemAlloc(Polygon_MemSize(4)) != blocks[i])
+			failures++;
+	}
+
+	for(int i = POLYPOOL_BATCH; i < numblocks; i++)
+		PolyPool_MemFree(blocks[i]);
+
+	Test_Report("polypool cold handoff", failures);
+}
+
+// the full four term distance, with no axial shortcut
+static float Test_PlaneDistance(const plane_t& p, const vec3& v)
+{
+	return (p.a * v.x) + (p.b * v.y) + (p.c * v.z) + p.d;
+}
+
+// every corner of the box against the plane
+static int Test_BoxSide(const plane_t& p, const vec3& bmin, const vec3& bmax)
+{
+	int sides = 0;
+
+	for(int i = 0; i < 8; i++)
+	{
+		vec3 corner((i & 1) ? bmax.x : bmin.x, (i & 2) ? bmax.y : bmin.y, (i & 4) ? bmax.z : bmin.z);
+
+		if(Test_PlaneDistance(p, corner) >= 0.0f)
+			sides |= PLANE_SIDE_FRONT;
+		else
+			sides |= PLANE_SIDE_BACK;
+	}
+
+	return sides;
+}
+
+static void Plane_Test2()
+{
+	const float epsilon = PLANE_DEFAULT_EPSILON;
+	int failures = 0;
+
+	// scaled +-X, Y and Z, then general planes
+	plane_t planes[12];
+
+	for(int i = 0; i < 12; i++)
+	{
+		float n[3] = { 0.0f, 0.0f, 0.0f };
+		float s = (i & 1) ? -1.0f : 1.0f;
+
+		if(i < 6)
+		{
+			n[i >> 1] = s * (1.5f + Test_Random() * 0.5f);
+		}
+		else
+		{
+			n[0] = Test_Random();
+			n[1] = Test_Random();
+			n[2] = s * (0.5f + fabsf(Test_Random()));
+		}
+
+		planes[i] = plane_t(n[0], n[1], n[2], Test_Random() * 2.0f);
+
+		int type = (i < 6) ? (i >> 1) : PLANE_NONAXIAL;
+		int signbits = ((n[0] < 0.0f) ? 1 : 0) | ((n[1] < 0.0f) ? 2 : 0) | ((n[2] < 0.0f) ? 4 : 0);
+
+		if(planes[i].type != type || planes[i].signbits != signbits || Plane_TypeForNormal(n[0], n[1], n[2]) != type)
+			failures++;
+	}
+
+	// Distance and Side against the four term form
+	for(int i = 0; i < 12; i++)
+	{
+		for(int j = 0; j < 200; j++)
+		{
+			vec3 v(Test_Random() * 4.0f, Test_Random() * 4.0f, Test_Random() * 4.0f);
+			float ref = Test_PlaneDistance(planes[i], v);
+			float d = planes[i].Distance(v);
+			int side = (ref > epsilon) ? PLANE_SIDE_FRONT : (ref < -epsilon) ? PLANE_SIDE_BACK : PLANE_SIDE_ON;
+
+			failures += Test_Compare(&d, &ref, 1, 1e-5f);
+			if(fabsf(fabsf(ref) - epsilon) > 1e-4f && planes[i].Side(v, epsilon) != side)
+				failures++;
+		}
+	}
+
+	// BoxOnPlaneSide against all eight corners, skipping boxes with a
+	// corner within rounding of the plane
+	for(int i = 0; i < 12; i++)
+	{
+		for(int j = 0; j < 200; j++)
+		{
+			vec3 a(Test_Random() * 3.0f, Test_Random() * 3.0f, Test_Random() * 3.0f);
+			vec3 b = a + vec3(fabsf(Test_Random()), fabsf(Test_Random()), fabsf(Test_Random())) * ((j & 1) ? 0.1f : 2.0f);
+			bool close = false;
+
+			for(int k = 0; k < 8; k++)
+			{
+				vec3 corner((k & 1) ? b.x : a.x, (k & 2) ? b.y : a.y, (k & 4) ? b.z : a.z);
+				close |= fabsf(Test_PlaneDistance(planes[i], corner)) < 1e-4f;
+			}
+
+			if(!close && planes[i].BoxOnPlaneSide(a, b) != Test_BoxSide(planes[i], a, b))
+				failures++;
+		}
+	}
+
+	// an axial split against the same plane with a negligible off axis
+	// component, which takes the general path. new axial points are
+	// snapped exactly onto the plane
+	for(int axis = 0; axis < 3; axis++)
+	{
+		polygon_t* ring = Test_RegularPolygon(40, 3.0f);
+		polygon_t* in = Polygon_Alloc(40);
+
+		// tilt the ring so it crosses planes along this axis
+		in->numvertices = 40;
+		for(int i = 0; i < 40; i++)
+		{
+			vec3 r = ring->vertices[i];
+
+			in->vertices[i][axis] = r.x;
+			in->vertices[i][(axis + 1) % 3] = r.y;
+			in->vertices[i][(axis + 2) % 3] = 0.3f * r.x;
+		}
+
+		for(int j = 0; j < 10; j++)
+		{
+			vec3 normal(0.0f, 0.0f, 0.0f);
+			normal[axis] = ((j & 1) ? -1.0f : 1.0f) * (1.0f + fabsf(Test_Random()));
+
+			vec3 general = normal;
+			general[(axis + 1) % 3] = 1e-30f;
+
+			float dist = Test_Random() * 2.0f;
+			polygon_t* front[2];
+			polygon_t* back[2];
+
+			Polygon_SplitWithPlane(in, normal, dist, 0.01f, &front[0], &back[0]);
+			Polygon_SplitWithPlane(in, general, dist, 0.01f, &front[1], &back[1]);
+
+			if(!front[0] || !back[0] || !front[1] || !back[1])
+			{
+				failures++;
+				continue;
+			}
+
+			if(front[0]->numvertices != front[1]->numvertices || back[0]->numvertices != back[1]->numvertices)
+				failures++;
+			else
+			{
+				failures += Test_CompareVec3(front[0]->vertices, front[1]->vertices, front[0]->numvertices, 1e-5f);
+				failures += Test_CompareVec3(back[0]->vertices, back[1]->vertices, back[0]->numvertices, 1e-5f);
+			}
+
+			polygon_t* pieces[2] = { front[0], back[0] };
+
+			for(int k = 0; k < 2; k++)
+			{
+				for(int v = 0; v < pieces[k]->numvertices; v++)
+				{
+					vec3 p = pieces[k]->vertices[v];
+					bool original = false;
+
+					for(int i = 0; i < in->numvertices; i++)
+						original |= (p == in->vertices[i]);
+
+					if(!original && p[axis] != dist / normal[axis])
+						failures++;
+				}
+			}
+
+			for(int k = 0; k < 2; k++)
+			{
+				Polygon_Free(front[k]);
+				Polygon_Free(back[k]);
+			}
+		}
+
+		Polygon_Free(in);
+		Polygon_Free(ring);
+	}
+
+	Test_Report("plane axial", failures);
+}
+
+static std::atomic<int> test_otherlive(0);
+
+static void *Test_OtherAlloc(int numbytes)
+{
+	test_otherlive++;
+	return malloc(numbytes);
+}
+
+static void Test_OtherFree(void *p)
+{
+	test_otherlive--;
+	free(p);
+}
+
+static void Allocator_Test2()
+{
+	int failures = 0;
+
+	// switching callbacks with polygons outstanding, each goes back to the
+	// pair it came from
+	Polygon_SetMemCallbacks(Test_CallbackAlloc, Test_CallbackFree);
+	polygon_t *p0 = Polygon_Alloc(8);
+	allocator_t *first = Allocator_Current();
+
+	Polygon_SetMemCallbacks(Test_OtherAlloc, Test_OtherFree);
+	polygon_t *p1 = Polygon_Alloc(8);
+
+	if(test_callbacklive != 1 || test_otherlive != 1 || p0->allocator == p1->allocator)
+		failures++;
+
+	Polygon_Free(p0);
+	if(test_callbacklive != 0 || test_otherlive != 1)
+		failures++;
+
+	// installing a pair again reuses its allocator
+	Polygon_SetMemCallbacks(Test_CallbackAlloc, Test_CallbackFree);
+	if(Allocator_Current() != first)
+		failures++;
+
+	// a missing free restores the default rather than failing later
+	Polygon_SetMemCallbacks(Test_OtherAlloc, NULL);
+	if(Allocator_Current() != Allocator_Default())
+		failures++;
+
+	Polygon_Free(p1);
+	if(test_otherlive != 0)
+		failures++;
+
+	Test_Report("allocator callbacks", failures);
+}
+
 int main(int argc, char *argv[])
 {
 	Polygon_Test1();
@@ -107,5 +2579,63 @@ int main(int argc, char *argv[])
 
 	Polygon_Test5();
 
+	Polygon_Test6();
+
+	Polygon_Test7();
+
+	Polygon_Test8();
+
+	Vec3SoA_Test1();
+
+	Simd_Test1();
+
+	Normalize_Test1();
+
+	Mat4x4_Test1();
+
+	TVector_Test1();
+
+	VecExpr_Test1();
+
+	VertexStream_Test1();
+
+	Bounds_Test1();
+
+	Transform_Test1();
+
+	Mat3x4_Test1();
+
+	MatrixBatch_Test1();
+
+	Mat4x4_Test2();
+
+	MatrixBatch_Test2();
+
+	Hierarchy_Test1();
+
+	Frustum_Test1();
+
+	Plane_Test1();
+
+	PlaneSet_Test1();
+
+	PlanePool_Test1();
+
+	RayPacket_Test1();
+
+	Arena_Test1();
+
+	PolyPool_Test1();
+
+	Allocator_Test1();
+
+	Polygon_Test9();
+
+	PolyPool_Test2();
+
+	Plane_Test2();
+
+	Allocator_Test2();
+
 	return 0;
 }
@@ -0,0 +1,101 @@
+#include <string.h>
+#include "raypacket.h"
+#include "planeset.h"
+
+#define SIMD_KERNELS "raypacket_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(RayPacket_Kernel);
+
+// edge planes of polygons up to this many vertices are built on the stack,
+// the largest polypool size class, bigger polygons allocate a plane_set
+#define RAYPACKET_MAXEDGES	64
+
+static int RayPacket_CountBits(const unsigned int *bits, int numwords)
+{
+	int count = 0;
+
+	for(int i = 0; i < numwords; i++)
+	{
+		for(unsigned int w = bits[i]; w; w &= w - 1)
+			count++;
+	}
+
+	return count;
+}
+
+static int RayPacket_Run(const plane_t& p, const plane_set *edges, const vec3_soa *origins, const vec3_soa *dirs, float *fractions, unsigned int *hits)
+{
+	int numrays = origins->numvectors;
+
+	memset(hits, 0, RAYPACKET_MASKWORDS(numrays) * sizeof(unsigned int));
+
+	int i = SIMD_CALL(RayPacket_Kernel)(origins, dirs, &p, edges, fractions, hits, 0, numrays);
+	RayPacket_Kernel_scalar(origins, dirs, &p, edges, fractions, hits, i, numrays);
+
+	return RayPacket_CountBits(hits, RAYPACKET_MASKWORDS(numrays));
+}
+
+/*-----------------------------------------------------------------------------
+	public interface
+-----------------------------------------------------------------------------*/
+
+int RayPacket_IntersectPlane(const plane_t& p, const vec3_soa *origins, const vec3_soa *dirs, float *fractions, unsigned int *hits)
+{
+	return RayPacket_Run(p, NULL, origins, dirs, fractions, hits);
+}
+
+// the polygon plane and one inward facing plane per edge, as in
+// Polygon_RayIntersection
+int RayPacket_IntersectPolygon(polygon_t *p, const vec3_soa *origins, const vec3_soa *dirs, float *fractions, unsigned int *hits)
+{
+	vec3 n = Polygon_ProjectedArea(p);
+	if(LengthSquared(n) == 0.0f)
+	{
+		for(int i = 0; i < origins->numvectors; i++)
+			fractions[i] = RAYPACKET_MISS;
+
+		memset(hits, 0, RAYPACKET_MASKWORDS(origins->numvectors) * sizeof(unsigned int));
+		return 0;
+	}
+
+	n = Normalize(n);
+
+	float		ea[RAYPACKET_MAXEDGES];
+	float		eb[RAYPACKET_MAXEDGES];
+	float		ec[RAYPACKET_MAXEDGES];
+	float		ed[RAYPACKET_MAXEDGES];
+	plane_set	stackedges;
+	plane_set	*edges = &stackedges;
+
+	if(p->numvertices > RAYPACKET_MAXEDGES)
+	{
+		edges = PlaneSet_Alloc(p->numvertices);
+	}
+	else
+	{
+		// the kernel only walks numplanes, so no padding slots are needed
+		stackedges.maxplanes	= RAYPACKET_MAXEDGES;
+		stackedges.numplanes	= 0;
+		stackedges.a		= ea;
+		stackedges.b		= eb;
+		stackedges.c		= ec;
+		stackedges.d		= ed;
+	}
+
+	for(int i = 0; i < p->numvertices; i++)
+	{
+		vec3 v0 = p->vertices[i];
+		vec3 v1 = p->vertices[(i + 1) % p->numvertices];
+		vec3 e = Cross(n, v1 - v0);
+
+		PlaneSet_Add(edges, plane_t(e, Dot(e, v0)));
+	}
+
+	int numhits = RayPacket_Run(plane_t(n, Dot(n, p->vertices[0])), edges, origins, dirs, fractions, hits);
+
+	if(edges != &stackedges)
+		PlaneSet_Free(edges);
+
+	return numhits;
+}
@@ -0,0 +1,35 @@
+/*=============================================================================
+	raypacket.h
+============================================================================*/
+
+#ifndef __RAYPACKET_H__
+#define __RAYPACKET_H__
+
+#include "vector.h"
+#include "plane.h"
+#include "polygon.h"
+#include "vec3soa.h"
+
+// fraction written for rays that miss
+#define RAYPACKET_MISS		(1e30f)
+
+// words needed for a per-ray bitmask
+#define RAYPACKET_MASKWORDS(n)	(((n) + 31) >> 5)
+
+/*-----------------------------------------------------------------------------
+	ray packets
+
+	ray i is origins[i] + fraction * dirs[i], with origins and dirs holding
+	the same numvectors. the rays are intersected SIMD_WIDTH at a time, the
+	same tests as plane_t::RayIntersection and Polygon_RayIntersection, so
+	bundles of coherent rays from one eye or cursor share the plane setup.
+
+	fractions gets one float per ray, RAYPACKET_MISS for misses, and bit i
+	of hits is set when ray i hits. hits must hold RAYPACKET_MASKWORDS(n)
+	words. both return the number of hits
+-----------------------------------------------------------------------------*/
+
+int RayPacket_IntersectPlane(const plane_t& p, const vec3_soa *origins, const vec3_soa *dirs, float *fractions, unsigned int *hits);
+int RayPacket_IntersectPolygon(polygon_t *p, const vec3_soa *origins, const vec3_soa *dirs, float *fractions, unsigned int *hits);
+
+#endif
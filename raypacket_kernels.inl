@@ -0,0 +1,67 @@
+/*=============================================================================
+	raypacket_kernels.inl
+
+	per-tier ray packet intersection, see simd_variants.h. each lane is one
+	ray. the hit points of the packet are tested against the edge planes
+	until every lane has missed, so edges can be NULL for a bare plane
+-----------------------------------------------------------------------------*/
+
+static int SIMD_FN(RayPacket_Kernel)(const vec3_soa *o, const vec3_soa *dir, const plane_t *p, const plane_set *edges, float *fractions, unsigned int *hits, int start, int end)
+{
+	int i;
+
+	vfloat a = VF_SET1(p->a);
+	vfloat b = VF_SET1(p->b);
+	vfloat c = VF_SET1(p->c);
+	vfloat d = VF_SET1(p->d);
+	vfloat zero = VF_ZERO();
+	vfloat one = VF_SET1(1.0f);
+	vfloat miss = VF_SET1(RAYPACKET_MISS);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat ox = VF_LOADU(o->x + i);
+		vfloat oy = VF_LOADU(o->y + i);
+		vfloat oz = VF_LOADU(o->z + i);
+		vfloat dx = VF_LOADU(dir->x + i);
+		vfloat dy = VF_LOADU(dir->y + i);
+		vfloat dz = VF_LOADU(dir->z + i);
+
+		vfloat d1 = VF_FMADD(a, ox, d);
+		d1 = VF_FMADD(b, oy, d1);
+		d1 = VF_FMADD(c, oz, d1);
+
+		vfloat d2 = VF_MUL(a, dx);
+		d2 = VF_FMADD(b, dy, d2);
+		d2 = VF_FMADD(c, dz, d2);
+
+		// parallel lanes divide by one and are masked off
+		vmask hit = VF_CMPGT(VF_ABS(d2), zero);
+		vfloat f = VF_DIV(VF_SUB(zero, d1), VF_SELECT(hit, d2, one));
+
+		hit = VM_AND(hit, VF_CMPGE(f, zero));
+
+		if(edges && VM_BITS(hit))
+		{
+			vfloat hx = VF_FMADD(f, dx, ox);
+			vfloat hy = VF_FMADD(f, dy, oy);
+			vfloat hz = VF_FMADD(f, dz, oz);
+
+			for(int j = 0; j < edges->numplanes && VM_BITS(hit); j++)
+			{
+				vfloat e = VF_FMADD(VF_SET1(edges->a[j]), hx, VF_SET1(edges->d[j]));
+				e = VF_FMADD(VF_SET1(edges->b[j]), hy, e);
+				e = VF_FMADD(VF_SET1(edges->c[j]), hz, e);
+
+				hit = VM_AND(hit, VF_CMPGE(e, zero));
+			}
+		}
+
+		VF_STOREU(fractions + i, VF_SELECT(hit, f, miss));
+
+		unsigned int bits = (unsigned int)VM_BITS(hit) & ((1u << SIMD_WIDTH) - 1);
+		hits[i >> 5] |= bits << (i & 31);
+	}
+
+	return i;
+}
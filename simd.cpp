@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "simd.h"
+
+#if defined(SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+std::atomic<int> simd_tier(-1);
+
+static const char *simd_tiernames[SIMD_NUM_TIERS] =
+{
+	"scalar",
+	"sse2",
+	"avx2",
+	"avx512"
+};
+
+/*-----------------------------------------------------------------------------
+	cpu detection
+-----------------------------------------------------------------------------*/
+
+#if defined(SIMD_X86)
+static void Simd_CpuId(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// register state the os saves on a context switch
+static uint64_t Simd_XGetBV()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static int Simd_DetectTier()
+{
+	unsigned int regs[4];
+
+	Simd_CpuId(0, 0, regs);
+	int maxleaf = regs[0];
+
+	Simd_CpuId(1, 0, regs);
+	bool sse2	= (regs[3] & (1 << 26)) != 0;
+	bool fma	= (regs[2] & (1 << 12)) != 0;
+	bool osxsave	= (regs[2] & (1 << 27)) != 0;
+	bool avx	= (regs[2] & (1 << 28)) != 0;
+	bool f16c	= (regs[2] & (1 << 29)) != 0;
+
+	if(!sse2)
+		return SIMD_TIER_SCALAR;
+	if(!osxsave || !avx || maxleaf < 7)
+		return SIMD_TIER_SSE2;
+
+	// xmm and ymm state, then opmask and zmm state
+	uint64_t xcr0 = Simd_XGetBV();
+	if((xcr0 & 0x06) != 0x06)
+		return SIMD_TIER_SSE2;
+
+	Simd_CpuId(7, 0, regs);
+	bool avx2	= (regs[1] & (1 << 5)) != 0;
+	bool avx512f	= (regs[1] & (1 << 16)) != 0;
+
+	if(!avx2 || !fma || !f16c)
+		return SIMD_TIER_SSE2;
+	if(!avx512f || (xcr0 & 0xe0) != 0xe0)
+		return SIMD_TIER_AVX2;
+
+	return SIMD_TIER_AVX512;
+}
+#else
+static int Simd_DetectTier()
+{
+	return SIMD_TIER_SCALAR;
+}
+#endif
+
+int Simd_SupportedTier()
+{
+	static const int supported = Simd_DetectTier();
+
+	return supported;
+}
+
+int Simd_Init()
+{
+	int tier = Simd_SupportedTier();
+
+	const char *env = getenv(SIMD_ENV_VAR);
+	if(env)
+	{
+		for(int i = 0; i < SIMD_NUM_TIERS; i++)
+		{
+			if(!strcmp(env, simd_tiernames[i]) && i < tier)
+				tier = i;
+		}
+	}
+
+	// a Simd_SetTier or another thread's Init that got in first wins
+	int expected = -1;
+	if(!simd_tier.compare_exchange_strong(expected, tier, std::memory_order_relaxed))
+		return expected;
+
+	return tier;
+}
+
+// pin a tier, clamped to what the host supports. returns the tier in use
+int Simd_SetTier(int tier)
+{
+	int supported = Simd_SupportedTier();
+
+	if(tier < 0)
+		tier = 0;
+	if(tier > supported)
+		tier = supported;
+
+	simd_tier.store(tier, std::memory_order_relaxed);
+	return tier;
+}
+
+const char *Simd_TierName(int tier)
+{
+	if(tier < 0 || tier >= SIMD_NUM_TIERS)
+		return "unknown";
+
+	return simd_tiernames[tier];
+}
+
+/*-----------------------------------------------------------------------------
+	aligned memory
+-----------------------------------------------------------------------------*/
+
+void *Simd_AlignedAlloc(int numbytes)
+{
+	// store the pointer returned by malloc in front of the aligned block
+	char *p = (char*)malloc(numbytes + SIMD_ALIGN + sizeof(void*));
+	if(!p)
+		return NULL;
+
+	char *a = (char*)(((uintptr_t)(p + sizeof(void*)) + SIMD_ALIGN - 1) & ~(uintptr_t)(SIMD_ALIGN - 1));
+	((void**)a)[-1] = p;
+
+	return a;
+}
+
+void Simd_AlignedFree(void *p)
+{
+	if(p)
+		free(((void**)p)[-1]);
+}
@@ -0,0 +1,47 @@
+/*=============================================================================
+	simd.h
+============================================================================*/
+
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+#include <atomic>
+
+// batch kernels are compiled once per tier and the widest tier the host
+// supports is picked the first time a kernel runs. setting the environment
+// variable MATHLIB_SIMD to scalar, sse2, avx2 or avx512 pins a lower tier
+#define SIMD_TIER_SCALAR	0
+#define SIMD_TIER_SSE2		1
+#define SIMD_TIER_AVX2		2
+#define SIMD_TIER_AVX512	3
+#define SIMD_NUM_TIERS		4
+
+#define SIMD_ENV_VAR		"MATHLIB_SIMD"
+
+// alignment of buffers returned by Simd_AlignedAlloc, enough for a full
+// AVX-512 register
+#define SIMD_ALIGN		64
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#endif
+
+// -1 until the first kernel runs, any thread may get there first
+extern std::atomic<int> simd_tier;
+
+int Simd_Init();
+int Simd_SupportedTier();
+int Simd_SetTier(int tier);
+const char *Simd_TierName(int tier);
+
+void *Simd_AlignedAlloc(int numbytes);
+void Simd_AlignedFree(void *p);
+
+// current tier, detected on first use
+inline int Simd_GetTier()
+{
+	int tier = simd_tier.load(std::memory_order_relaxed);
+	return (tier >= 0) ? tier : Simd_Init();
+}
+
+#endif
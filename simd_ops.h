@@ -0,0 +1,173 @@
+/*=============================================================================
+	simd_ops.h
+
+	lane operations for the tier named by SIMD_BUILD_TIER. there is no include
+	guard, simd_variants.h includes this once per tier before each copy of a
+	kernel file. kernels are written against these macros only:
+
+	vfloat		SIMD_WIDTH floats
+	vmask		per-lane comparison result
+	SIMD_FN(name)	name with the tier suffix appended
+-----------------------------------------------------------------------------*/
+
+#undef SIMD_WIDTH
+#undef SIMD_FN
+#undef vfloat
+#undef vmask
+#undef VF_ZERO
+#undef VF_SET1
+#undef VF_LOAD
+#undef VF_LOADU
+#undef VF_STORE
+#undef VF_STOREU
+#undef VF_ADD
+#undef VF_SUB
+#undef VF_MUL
+#undef VF_DIV
+#undef VF_FMADD
+#undef VF_MIN
+#undef VF_MAX
+#undef VF_ABS
+#undef VF_SQRT
+#undef VF_RSQRT
+#undef VF_RCP
+#undef VF_CMPLT
+#undef VF_CMPLE
+#undef VF_CMPGT
+#undef VF_CMPGE
+#undef VF_SELECT
+#undef VM_AND
+#undef VM_OR
+#undef VM_BITS
+
+#if SIMD_BUILD_TIER == SIMD_TIER_SCALAR
+
+#define SIMD_WIDTH		1
+#define SIMD_FN(name)		name##_scalar
+#define vfloat			float
+#define vmask			int
+#define VF_ZERO()		(0.0f)
+#define VF_SET1(s)		((float)(s))
+#define VF_LOAD(p)		(*(p))
+#define VF_LOADU(p)		(*(p))
+#define VF_STORE(p, v)		(*(p) = (v))
+#define VF_STOREU(p, v)		(*(p) = (v))
+#define VF_ADD(a, b)		((a) + (b))
+#define VF_SUB(a, b)		((a) - (b))
+#define VF_MUL(a, b)		((a) * (b))
+#define VF_DIV(a, b)		((a) / (b))
+#define VF_FMADD(a, b, c)	(((a) * (b)) + (c))
+#define VF_MIN(a, b)		((a) < (b) ? (a) : (b))
+#define VF_MAX(a, b)		((a) > (b) ? (a) : (b))
+#define VF_ABS(a)		fabsf(a)
+#define VF_SQRT(a)		sqrtf(a)
+#define VF_RSQRT(a)		(1.0f / sqrtf(a))
+#define VF_RCP(a)		(1.0f / (a))
+#define VF_CMPLT(a, b)		((a) < (b))
+#define VF_CMPLE(a, b)		((a) <= (b))
+#define VF_CMPGT(a, b)		((a) > (b))
+#define VF_CMPGE(a, b)		((a) >= (b))
+#define VF_SELECT(m, a, b)	((m) ? (a) : (b))
+#define VM_AND(a, b)		((a) & (b))
+#define VM_OR(a, b)		((a) | (b))
+#define VM_BITS(m)		(m)
+
+#elif SIMD_BUILD_TIER == SIMD_TIER_SSE2
+
+#define SIMD_WIDTH		4
+#define SIMD_FN(name)		name##_sse2
+#define vfloat			__m128
+#define vmask			__m128
+#define VF_ZERO()		_mm_setzero_ps()
+#define VF_SET1(s)		_mm_set1_ps(s)
+#define VF_LOAD(p)		_mm_load_ps(p)
+#define VF_LOADU(p)		_mm_loadu_ps(p)
+#define VF_STORE(p, v)		_mm_store_ps(p, v)
+#define VF_STOREU(p, v)		_mm_storeu_ps(p, v)
+#define VF_ADD(a, b)		_mm_add_ps(a, b)
+#define VF_SUB(a, b)		_mm_sub_ps(a, b)
+#define VF_MUL(a, b)		_mm_mul_ps(a, b)
+#define VF_DIV(a, b)		_mm_div_ps(a, b)
+#define VF_FMADD(a, b, c)	_mm_add_ps(_mm_mul_ps(a, b), c)
+#define VF_MIN(a, b)		_mm_min_ps(a, b)
+#define VF_MAX(a, b)		_mm_max_ps(a, b)
+#define VF_ABS(a)		_mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)))
+#define VF_SQRT(a)		_mm_sqrt_ps(a)
+#define VF_RSQRT(a)		_mm_rsqrt_ps(a)
+#define VF_RCP(a)		_mm_rcp_ps(a)
+#define VF_CMPLT(a, b)		_mm_cmplt_ps(a, b)
+#define VF_CMPLE(a, b)		_mm_cmple_ps(a, b)
+#define VF_CMPGT(a, b)		_mm_cmpgt_ps(a, b)
+#define VF_CMPGE(a, b)		_mm_cmpge_ps(a, b)
+#define VF_SELECT(m, a, b)	_mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#define VM_AND(a, b)		_mm_and_ps(a, b)
+#define VM_OR(a, b)		_mm_or_ps(a, b)
+#define VM_BITS(m)		_mm_movemask_ps(m)
+
+#elif SIMD_BUILD_TIER == SIMD_TIER_AVX2
+
+#define SIMD_WIDTH		8
+#define SIMD_FN(name)		name##_avx2
+#define vfloat			__m256
+#define vmask			__m256
+#define VF_ZERO()		_mm256_setzero_ps()
+#define VF_SET1(s)		_mm256_set1_ps(s)
+#define VF_LOAD(p)		_mm256_load_ps(p)
+#define VF_LOADU(p)		_mm256_loadu_ps(p)
+#define VF_STORE(p, v)		_mm256_store_ps(p, v)
+#define VF_STOREU(p, v)		_mm256_storeu_ps(p, v)
+#define VF_ADD(a, b)		_mm256_add_ps(a, b)
+#define VF_SUB(a, b)		_mm256_sub_ps(a, b)
+#define VF_MUL(a, b)		_mm256_mul_ps(a, b)
+#define VF_DIV(a, b)		_mm256_div_ps(a, b)
+#define VF_FMADD(a, b, c)	_mm256_fmadd_ps(a, b, c)
+#define VF_MIN(a, b)		_mm256_min_ps(a, b)
+#define VF_MAX(a, b)		_mm256_max_ps(a, b)
+#define VF_ABS(a)		_mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)))
+#define VF_SQRT(a)		_mm256_sqrt_ps(a)
+#define VF_RSQRT(a)		_mm256_rsqrt_ps(a)
+#define VF_RCP(a)		_mm256_rcp_ps(a)
+#define VF_CMPLT(a, b)		_mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define VF_CMPLE(a, b)		_mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define VF_CMPGT(a, b)		_mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define VF_CMPGE(a, b)		_mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define VF_SELECT(m, a, b)	_mm256_blendv_ps(b, a, m)
+#define VM_AND(a, b)		_mm256_and_ps(a, b)
+#define VM_OR(a, b)		_mm256_or_ps(a, b)
+#define VM_BITS(m)		_mm256_movemask_ps(m)
+
+#elif SIMD_BUILD_TIER == SIMD_TIER_AVX512
+
+#define SIMD_WIDTH		16
+#define SIMD_FN(name)		name##_avx512
+#define vfloat			__m512
+#define vmask			__mmask16
+#define VF_ZERO()		_mm512_setzero_ps()
+#define VF_SET1(s)		_mm512_set1_ps(s)
+#define VF_LOAD(p)		_mm512_load_ps(p)
+#define VF_LOADU(p)		_mm512_loadu_ps(p)
+#define VF_STORE(p, v)		_mm512_store_ps(p, v)
+#define VF_STOREU(p, v)		_mm512_storeu_ps(p, v)
+#define VF_ADD(a, b)		_mm512_add_ps(a, b)
+#define VF_SUB(a, b)		_mm512_sub_ps(a, b)
+#define VF_MUL(a, b)		_mm512_mul_ps(a, b)
+#define VF_DIV(a, b)		_mm512_div_ps(a, b)
+#define VF_FMADD(a, b, c)	_mm512_fmadd_ps(a, b, c)
+#define VF_MIN(a, b)		_mm512_min_ps(a, b)
+#define VF_MAX(a, b)		_mm512_max_ps(a, b)
+#define VF_ABS(a)		_mm512_abs_ps(a)
+#define VF_SQRT(a)		_mm512_sqrt_ps(a)
+#define VF_RSQRT(a)		_mm512_rsqrt14_ps(a)
+#define VF_RCP(a)		_mm512_rcp14_ps(a)
+#define VF_CMPLT(a, b)		_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+#define VF_CMPLE(a, b)		_mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)
+#define VF_CMPGT(a, b)		_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)
+#define VF_CMPGE(a, b)		_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ)
+#define VF_SELECT(m, a, b)	_mm512_mask_blend_ps(m, b, a)
+#define VM_AND(a, b)		((__mmask16)((a) & (b)))
+#define VM_OR(a, b)		((__mmask16)((a) | (b)))
+#define VM_BITS(m)		((int)(m))
+
+#else
+#error "unknown SIMD_BUILD_TIER"
+#endif
@@ -0,0 +1,98 @@
+/*=============================================================================
+	simd_variants.h
+
+	compiles the kernel file named by SIMD_KERNELS once per tier. a module
+	defines SIMD_KERNELS, includes this header, declares a dispatch table for
+	each kernel with SIMD_DISPATCH and calls it through SIMD_CALL.
+
+	kernels take a [start, end) range, step SIMD_WIDTH lanes at a time and
+	return the index they stopped at. the _scalar variant always exists and
+	is used to finish the remainder.
+-----------------------------------------------------------------------------*/
+
+#ifndef __SIMD_VARIANTS_H__
+#define __SIMD_VARIANTS_H__
+
+#include <math.h>
+#include "simd.h"
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(SIMD_X86)
+#define SIMD_DISPATCH(name) \
+	static decltype(&name##_scalar) const name##_variants[SIMD_NUM_TIERS] = \
+		{ name##_scalar, name##_sse2, name##_avx2, name##_avx512 }
+#else
+#define SIMD_DISPATCH(name) \
+	static decltype(&name##_scalar) const name##_variants[SIMD_NUM_TIERS] = \
+		{ name##_scalar, name##_scalar, name##_scalar, name##_scalar }
+#endif
+
+#define SIMD_CALL(name)		(name##_variants[Simd_GetTier()])
+
+#endif
+
+#ifndef SIMD_KERNELS
+#error "define SIMD_KERNELS before including simd_variants.h"
+#endif
+
+#define SIMD_BUILD_TIER SIMD_TIER_SCALAR
+#include "simd_ops.h"
+#include SIMD_KERNELS
+#undef SIMD_BUILD_TIER
+
+#if defined(SIMD_X86)
+
+#define SIMD_BUILD_TIER SIMD_TIER_SSE2
+#include "simd_ops.h"
+#include SIMD_KERNELS
+#undef SIMD_BUILD_TIER
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma,f16c"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,f16c")
+#endif
+
+#define SIMD_BUILD_TIER SIMD_TIER_AVX2
+#include "simd_ops.h"
+#include SIMD_KERNELS
+#undef SIMD_BUILD_TIER
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push(__attribute__((target("avx512f,avx2,fma,f16c"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma,f16c")
+#endif
+
+// gcc 12 warns that the masked min/max builtins read an uninitialized
+// source, the mask covers every lane so it is never used
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#define SIMD_BUILD_TIER SIMD_TIER_AVX512
+#include "simd_ops.h"
+#include SIMD_KERNELS
+#undef SIMD_BUILD_TIER
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
+
+#undef SIMD_KERNELS
@@ -0,0 +1,370 @@
+/*=============================================================================
+	tmatrix.h
+
+	generic mat<R, C, T> built from R rows of vec<C, T>. all operations are
+	constexpr, so fixed transforms and lookup tables fold at compile time.
+	products expand over index sequences and unroll for every size.
+============================================================================*/
+
+#ifndef __TMATRIX_H__
+#define __TMATRIX_H__
+
+#include "tvector.h"
+#include "matrix.h"
+
+template<int R, int C, typename T>
+class mat;
+
+/*-----------------------------------------------------------------------------
+	unrolling helpers
+-----------------------------------------------------------------------------*/
+
+template<int R, int C, typename T, size_t... I>
+constexpr mat<R, C, T> TMat_Add(const mat<R, C, T>& a, const mat<R, C, T>& b, std::index_sequence<I...>)
+{
+	return mat<R, C, T>((a.m[I] + b.m[I])...);
+}
+
+template<int R, int C, typename T, size_t... I>
+constexpr mat<R, C, T> TMat_Sub(const mat<R, C, T>& a, const mat<R, C, T>& b, std::index_sequence<I...>)
+{
+	return mat<R, C, T>((a.m[I] - b.m[I])...);
+}
+
+template<int R, int C, typename T, size_t... I>
+constexpr mat<R, C, T> TMat_Scale(const mat<R, C, T>& a, T s, std::index_sequence<I...>)
+{
+	return mat<R, C, T>((s * a.m[I])...);
+}
+
+template<int R, int C, typename T, size_t... I>
+constexpr bool TMat_Equal(const mat<R, C, T>& a, const mat<R, C, T>& b, std::index_sequence<I...>)
+{
+	return TVec_All((a.m[I] == b.m[I])...);
+}
+
+// column j as a vector
+template<int R, int C, typename T, size_t... I>
+constexpr vec<R, T> TMat_Col(const mat<R, C, T>& a, int j, std::index_sequence<I...>)
+{
+	return vec<R, T>(a.m[I].v[j]...);
+}
+
+// row vector times matrix: sum of the rows of b scaled by the elements of v
+template<int R, int C, typename T, size_t... I>
+constexpr vec<C, T> TMat_VecMul(const vec<R, T>& v, const mat<R, C, T>& b, std::index_sequence<I...>)
+{
+	return TVec_Sum((v.v[I] * b.m[I])...);
+}
+
+template<int R, int C, typename T, size_t... I>
+constexpr vec<R, T> TMat_MulVec(const mat<R, C, T>& a, const vec<C, T>& v, std::index_sequence<I...>)
+{
+	return vec<R, T>(Dot(a.m[I], v)...);
+}
+
+template<int R, int K, int C, typename T, size_t... I>
+constexpr mat<R, C, T> TMat_Mul(const mat<R, K, T>& a, const mat<K, C, T>& b, std::index_sequence<I...>)
+{
+	return mat<R, C, T>(TMat_VecMul(a.m[I], b, std::make_index_sequence<K>())...);
+}
+
+template<int R, int C, typename T, size_t... J>
+constexpr mat<C, R, T> TMat_Transpose(const mat<R, C, T>& a, std::index_sequence<J...>)
+{
+	return mat<C, R, T>(TMat_Col(a, (int)J, std::make_index_sequence<R>())...);
+}
+
+template<int N, typename T, size_t... I>
+constexpr vec<N, T> TMat_IdentityRow(int r, std::index_sequence<I...>)
+{
+	return vec<N, T>((T)((int)I == r ? 1 : 0)...);
+}
+
+template<int N, typename T, size_t... I>
+constexpr mat<N, N, T> TMat_Identity(std::index_sequence<I...>)
+{
+	return mat<N, N, T>(TMat_IdentityRow<N, T>((int)I, std::make_index_sequence<N>())...);
+}
+
+/*-----------------------------------------------------------------------------
+	mat<R, C, T>
+-----------------------------------------------------------------------------*/
+
+template<int R, int C, typename T>
+class mat
+{
+public:
+	typedef std::make_index_sequence<R> indices;
+
+	vec<C, T>	m[R];
+
+	// constructors
+	constexpr mat()
+		: m{}
+	{}
+
+	template<typename... A>
+	constexpr mat(const vec<C, T>& first, const A&... rest)
+		: m{ first, rest... }
+	{
+		static_assert(sizeof...(A) + 1 == R, "wrong number of rows");
+	}
+
+	static constexpr mat Identity()
+	{
+		static_assert(R == C, "identity of a non-square matrix");
+		return TMat_Identity<R, T>(indices());
+	}
+
+	constexpr vec<C, T> operator[](int i) const
+	{
+		return m[i];
+	}
+
+	constexpr vec<C, T>& operator[](int i)
+	{
+		return m[i];
+	}
+
+	constexpr mat operator-() const
+	{
+		return TMat_Scale(*this, (T)-1, indices());
+	}
+
+	constexpr mat<C, R, T> Transposed() const
+	{
+		return TMat_Transpose(*this, std::make_index_sequence<C>());
+	}
+
+	T* Ptr()
+	{
+		return m[0].v;
+	}
+
+	constexpr const T* Ptr() const
+	{
+		return m[0].v;
+	}
+};
+
+template<int R, int C, typename T>
+constexpr mat<R, C, T> operator+(const mat<R, C, T>& a, const mat<R, C, T>& b)
+{
+	return TMat_Add(a, b, std::make_index_sequence<R>());
+}
+
+template<int R, int C, typename T>
+constexpr mat<R, C, T> operator-(const mat<R, C, T>& a, const mat<R, C, T>& b)
+{
+	return TMat_Sub(a, b, std::make_index_sequence<R>());
+}
+
+template<int R, int C, typename T>
+constexpr mat<R, C, T> operator*(const T s, const mat<R, C, T>& a)
+{
+	return TMat_Scale(a, s, std::make_index_sequence<R>());
+}
+
+template<int R, int C, typename T>
+constexpr mat<R, C, T> operator*(const mat<R, C, T>& a, const T s)
+{
+	return TMat_Scale(a, s, std::make_index_sequence<R>());
+}
+
+// matrix-matrix multiply
+template<int R, int K, int C, typename T>
+constexpr mat<R, C, T> operator*(const mat<R, K, T>& a, const mat<K, C, T>& b)
+{
+	return TMat_Mul(a, b, std::make_index_sequence<R>());
+}
+
+// matrix-vector post multiply
+template<int R, int C, typename T>
+constexpr vec<R, T> operator*(const mat<R, C, T>& a, const vec<C, T>& v)
+{
+	return TMat_MulVec(a, v, std::make_index_sequence<R>());
+}
+
+// vector-matrix pre multiply
+template<int R, int C, typename T>
+constexpr vec<C, T> operator*(const vec<R, T>& v, const mat<R, C, T>& a)
+{
+	return TMat_VecMul(v, a, std::make_index_sequence<R>());
+}
+
+template<int R, int C, typename T>
+constexpr bool operator==(const mat<R, C, T>& a, const mat<R, C, T>& b)
+{
+	return TMat_Equal(a, b, std::make_index_sequence<R>());
+}
+
+template<int R, int C, typename T>
+constexpr bool operator!=(const mat<R, C, T>& a, const mat<R, C, T>& b)
+{
+	return !TMat_Equal(a, b, std::make_index_sequence<R>());
+}
+
+template<int R, int C, typename T>
+constexpr mat<C, R, T> Transpose(const mat<R, C, T>& a)
+{
+	return a.Transposed();
+}
+
+/*-----------------------------------------------------------------------------
+	determinant and inverse
+
+	closed forms for 2x2 and 3x3, laplace expansion along the first row for
+	larger sizes. Inverse returns the zero matrix when the determinant is zero
+-----------------------------------------------------------------------------*/
+
+// matrix with row r and column c removed
+template<int N, typename T>
+constexpr mat<N - 1, N - 1, T> TMat_Minor(const mat<N, N, T>& a, int r, int c)
+{
+	mat<N - 1, N - 1, T> b;
+
+	for(int i = 0, bi = 0; i < N; i++)
+	{
+		if(i == r)
+			continue;
+
+		for(int j = 0, bj = 0; j < N; j++)
+		{
+			if(j == c)
+				continue;
+
+			b.m[bi].v[bj++] = a.m[i].v[j];
+		}
+		bi++;
+	}
+
+	return b;
+}
+
+template<typename T>
+constexpr T Determinant(const mat<1, 1, T>& a)
+{
+	return a.m[0].v[0];
+}
+
+template<typename T>
+constexpr T Determinant(const mat<2, 2, T>& a)
+{
+	return (a.m[0].v[0] * a.m[1].v[1]) - (a.m[0].v[1] * a.m[1].v[0]);
+}
+
+template<typename T>
+constexpr T Determinant(const mat<3, 3, T>& a)
+{
+	return Dot(a.m[0], Cross(a.m[1], a.m[2]));
+}
+
+template<int N, typename T>
+constexpr T Determinant(const mat<N, N, T>& a)
+{
+	T det = 0;
+
+	for(int j = 0; j < N; j++)
+	{
+		T cofactor = Determinant(TMat_Minor(a, 0, j));
+		det += (j & 1) ? -a.m[0].v[j] * cofactor : a.m[0].v[j] * cofactor;
+	}
+
+	return det;
+}
+
+template<int N, typename T>
+constexpr mat<N, N, T> Inverse(const mat<N, N, T>& a)
+{
+	mat<N, N, T> r;
+
+	T det = Determinant(a);
+	if(det == 0)
+		return r;
+
+	T invdet = (T)1 / det;
+
+	// transposed cofactors over the determinant
+	for(int i = 0; i < N; i++)
+	{
+		for(int j = 0; j < N; j++)
+		{
+			T cofactor = Determinant(TMat_Minor(a, i, j));
+			r.m[j].v[i] = ((i + j) & 1) ? -cofactor * invdet : cofactor * invdet;
+		}
+	}
+
+	return r;
+}
+
+template<typename T>
+constexpr mat<2, 2, T> Inverse(const mat<2, 2, T>& a)
+{
+	T det = Determinant(a);
+	if(det == 0)
+		return mat<2, 2, T>();
+
+	T invdet = (T)1 / det;
+
+	return mat<2, 2, T>
+	(
+		vec<2, T>( a.m[1].v[1] * invdet, -a.m[0].v[1] * invdet),
+		vec<2, T>(-a.m[1].v[0] * invdet,  a.m[0].v[0] * invdet)
+	);
+}
+
+template<typename T>
+constexpr mat<3, 3, T> Inverse(const mat<3, 3, T>& a)
+{
+	// the rows of the inverse transpose are the cross products of the rows
+	vec<3, T> c0 = Cross(a.m[1], a.m[2]);
+	vec<3, T> c1 = Cross(a.m[2], a.m[0]);
+	vec<3, T> c2 = Cross(a.m[0], a.m[1]);
+
+	T det = Dot(a.m[0], c0);
+	if(det == 0)
+		return mat<3, 3, T>();
+
+	return ((T)1 / det) * mat<3, 3, T>(c0, c1, c2).Transposed();
+}
+
+/*-----------------------------------------------------------------------------
+	instantiations
+-----------------------------------------------------------------------------*/
+
+typedef mat<2, 2, float>	mat2x2f;
+typedef mat<3, 3, float>	mat3x3f;
+typedef mat<3, 4, float>	mat3x4f;
+typedef mat<4, 4, float>	mat4x4f;
+typedef mat<2, 2, double>	mat2x2d;
+typedef mat<3, 3, double>	mat3x3d;
+typedef mat<3, 4, double>	mat3x4d;
+typedef mat<4, 4, double>	mat4x4d;
+
+// conversions to and from the fixed float classes in matrix.h
+template<typename T>
+inline mat<4, 4, T> TMat(const mat4x4& a)
+{
+	return mat<4, 4, T>(TVec<T>(a.m[0]), TVec<T>(a.m[1]), TVec<T>(a.m[2]), TVec<T>(a.m[3]));
+}
+
+template<typename T>
+inline mat<3, 3, T> TMat(const mat3x3& a)
+{
+	return mat<3, 3, T>(TVec<T>(a.m[0]), TVec<T>(a.m[1]), TVec<T>(a.m[2]));
+}
+
+template<typename T>
+inline mat4x4 ToMat4x4(const mat<4, 4, T>& a)
+{
+	return mat4x4(ToVec4(a.m[0]), ToVec4(a.m[1]), ToVec4(a.m[2]), ToVec4(a.m[3]));
+}
+
+template<typename T>
+inline mat3x3 ToMat3x3(const mat<3, 3, T>& a)
+{
+	return mat3x3(ToVec3(a.m[0]), ToVec3(a.m[1]), ToVec3(a.m[2]));
+}
+
+#endif
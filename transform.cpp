@@ -0,0 +1,261 @@
+#include <assert.h>
+#include "transform.h"
+#include "parallel.h"
+
+#define SIMD_KERNELS "transform_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(Transform_Kernel);
+
+// vertices deinterleaved per pass, and per worker chunk
+#define TRANSFORM_BLOCK		256
+#define TRANSFORM_GRAIN		(16 * TRANSFORM_BLOCK)
+
+typedef struct transform_job_s
+{
+	float		m[12];
+
+	const char	*in;
+	int		instride;
+	char		*out;
+	int		outstride;
+
+	const vec3_soa	*insoa;
+	vec3_soa	*outsoa;
+
+} transform_job_t;
+
+/*-----------------------------------------------------------------------------
+	jobs
+-----------------------------------------------------------------------------*/
+
+static void Transform_SetMatrix(transform_job_t *job, const float m[3][4], bool points)
+{
+	for(int i = 0; i < 3; i++)
+	{
+		job->m[(i * 4) + 0] = m[i][0];
+		job->m[(i * 4) + 1] = m[i][1];
+		job->m[(i * 4) + 2] = m[i][2];
+		job->m[(i * 4) + 3] = points ? m[i][3] : 0.0f;
+	}
+}
+
+static void Transform_SetMatrix(transform_job_t *job, const mat3x4& m, bool points)
+{
+	float rows[3][4];
+
+	for(int i = 0; i < 3; i++)
+	{
+		for(int j = 0; j < 4; j++)
+			rows[i][j] = m.m[i][j];
+	}
+
+	Transform_SetMatrix(job, rows, points);
+}
+
+static void Transform_SetMatrix(transform_job_t *job, const mat4x4& m, bool points)
+{
+	Transform_SetMatrix(job, mat3x4(m), points);
+}
+
+static void Transform_StridedChunk(void *context, int start, int end)
+{
+	transform_job_t *job = (transform_job_t*)context;
+
+	float	x[TRANSFORM_BLOCK];
+	float	y[TRANSFORM_BLOCK];
+	float	z[TRANSFORM_BLOCK];
+
+	// deinterleave a block, transform the planes and interleave it back
+	for(int block = start; block < end; block += TRANSFORM_BLOCK)
+	{
+		int count = end - block;
+		if(count > TRANSFORM_BLOCK)
+			count = TRANSFORM_BLOCK;
+
+		const char *in = job->in + ((size_t)block * job->instride);
+		for(int i = 0; i < count; i++, in += job->instride)
+		{
+			const float *v = (const float*)in;
+
+			x[i] = v[0];
+			y[i] = v[1];
+			z[i] = v[2];
+		}
+
+		int i = SIMD_CALL(Transform_Kernel)(x, y, z, x, y, z, job->m, 0, count);
+		Transform_Kernel_scalar(x, y, z, x, y, z, job->m, i, count);
+
+		char *out = job->out + ((size_t)block * job->outstride);
+		for(int i = 0; i < count; i++, out += job->outstride)
+		{
+			float *v = (float*)out;
+
+			v[0] = x[i];
+			v[1] = y[i];
+			v[2] = z[i];
+		}
+	}
+}
+
+static void Transform_SoAChunk(void *context, int start, int end)
+{
+	transform_job_t *job = (transform_job_t*)context;
+
+	const vec3_soa	*in = job->insoa;
+	vec3_soa	*out = job->outsoa;
+
+	int i = SIMD_CALL(Transform_Kernel)(out->x, out->y, out->z, in->x, in->y, in->z, job->m, start, end);
+	Transform_Kernel_scalar(out->x, out->y, out->z, in->x, in->y, in->z, job->m, i, end);
+}
+
+static void Transform_RunStrided(transform_job_t *job, void *out, int outstride, const void *in, int instride, int count)
+{
+	job->in		= (const char*)in;
+	job->instride	= instride;
+	job->out	= (char*)out;
+	job->outstride	= outstride;
+
+	Parallel_For(count, TRANSFORM_GRAIN, Transform_StridedChunk, job);
+}
+
+static void Transform_RunSoA(transform_job_t *job, vec3_soa *out, const vec3_soa *in)
+{
+	assert(in->numvectors <= out->maxvectors);
+
+	job->insoa	= in;
+	job->outsoa	= out;
+
+	Parallel_For(in->numvectors, TRANSFORM_GRAIN, Transform_SoAChunk, job);
+	out->numvectors = in->numvectors;
+}
+
+/*-----------------------------------------------------------------------------
+	public interface
+-----------------------------------------------------------------------------*/
+
+void Transform_Points(vec3 *out, const mat4x4& m, const vec3 *in, int numpoints)
+{
+	Transform_PointsStrided(out, sizeof(vec3), m, in, sizeof(vec3), numpoints);
+}
+
+void Transform_Points(vec3 *out, const float m[3][4], const vec3 *in, int numpoints)
+{
+	Transform_PointsStrided(out, sizeof(vec3), m, in, sizeof(vec3), numpoints);
+}
+
+void Transform_Points(vec3 *out, const mat3x4& m, const vec3 *in, int numpoints)
+{
+	Transform_PointsStrided(out, sizeof(vec3), m, in, sizeof(vec3), numpoints);
+}
+
+void Transform_Vectors(vec3 *out, const mat4x4& m, const vec3 *in, int numvectors)
+{
+	Transform_VectorsStrided(out, sizeof(vec3), m, in, sizeof(vec3), numvectors);
+}
+
+void Transform_Vectors(vec3 *out, const float m[3][4], const vec3 *in, int numvectors)
+{
+	Transform_VectorsStrided(out, sizeof(vec3), m, in, sizeof(vec3), numvectors);
+}
+
+void Transform_Vectors(vec3 *out, const mat3x4& m, const vec3 *in, int numvectors)
+{
+	Transform_VectorsStrided(out, sizeof(vec3), m, in, sizeof(vec3), numvectors);
+}
+
+void Transform_PointsStrided(void *out, int outstride, const mat4x4& m, const void *in, int instride, int numpoints)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, true);
+	Transform_RunStrided(&job, out, outstride, in, instride, numpoints);
+}
+
+void Transform_PointsStrided(void *out, int outstride, const float m[3][4], const void *in, int instride, int numpoints)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, true);
+	Transform_RunStrided(&job, out, outstride, in, instride, numpoints);
+}
+
+void Transform_PointsStrided(void *out, int outstride, const mat3x4& m, const void *in, int instride, int numpoints)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, true);
+	Transform_RunStrided(&job, out, outstride, in, instride, numpoints);
+}
+
+void Transform_VectorsStrided(void *out, int outstride, const mat4x4& m, const void *in, int instride, int numvectors)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, false);
+	Transform_RunStrided(&job, out, outstride, in, instride, numvectors);
+}
+
+void Transform_VectorsStrided(void *out, int outstride, const float m[3][4], const void *in, int instride, int numvectors)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, false);
+	Transform_RunStrided(&job, out, outstride, in, instride, numvectors);
+}
+
+void Transform_VectorsStrided(void *out, int outstride, const mat3x4& m, const void *in, int instride, int numvectors)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, false);
+	Transform_RunStrided(&job, out, outstride, in, instride, numvectors);
+}
+
+void Transform_PointsSoA(vec3_soa *out, const mat4x4& m, const vec3_soa *in)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, true);
+	Transform_RunSoA(&job, out, in);
+}
+
+void Transform_PointsSoA(vec3_soa *out, const float m[3][4], const vec3_soa *in)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, true);
+	Transform_RunSoA(&job, out, in);
+}
+
+void Transform_PointsSoA(vec3_soa *out, const mat3x4& m, const vec3_soa *in)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, true);
+	Transform_RunSoA(&job, out, in);
+}
+
+void Transform_VectorsSoA(vec3_soa *out, const mat4x4& m, const vec3_soa *in)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, false);
+	Transform_RunSoA(&job, out, in);
+}
+
+void Transform_VectorsSoA(vec3_soa *out, const float m[3][4], const vec3_soa *in)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, false);
+	Transform_RunSoA(&job, out, in);
+}
+
+void Transform_VectorsSoA(vec3_soa *out, const mat3x4& m, const vec3_soa *in)
+{
+	transform_job_t job;
+
+	Transform_SetMatrix(&job, m, false);
+	Transform_RunSoA(&job, out, in);
+}
@@ -0,0 +1,48 @@
+/*=============================================================================
+	transform.h
+============================================================================*/
+
+#ifndef __TRANSFORM_H__
+#define __TRANSFORM_H__
+
+#include "vector.h"
+#include "matrix.h"
+#include "vec3soa.h"
+
+/*-----------------------------------------------------------------------------
+	batch transforms
+
+	points are transformed with w = 1 and pick up the translation column,
+	vectors are transformed with w = 0. the mat4x4 versions use the top three
+	rows like Matrix_TransformPoint, the bottom row is ignored. the mat3x4
+	and float[3][4] versions take rows in the md5jointmat_t layout.
+
+	out may be the same array as in, but must not partially overlap it.
+	large arrays are split across the worker threads.
+-----------------------------------------------------------------------------*/
+
+void Transform_Points(vec3 *out, const mat4x4& m, const vec3 *in, int numpoints);
+void Transform_Points(vec3 *out, const float m[3][4], const vec3 *in, int numpoints);
+void Transform_Points(vec3 *out, const mat3x4& m, const vec3 *in, int numpoints);
+void Transform_Vectors(vec3 *out, const mat4x4& m, const vec3 *in, int numvectors);
+void Transform_Vectors(vec3 *out, const float m[3][4], const vec3 *in, int numvectors);
+void Transform_Vectors(vec3 *out, const mat3x4& m, const vec3 *in, int numvectors);
+
+// the same over interleaved vertex data. each element starts with a vec3
+// and elements are instride and outstride bytes apart
+void Transform_PointsStrided(void *out, int outstride, const mat4x4& m, const void *in, int instride, int numpoints);
+void Transform_PointsStrided(void *out, int outstride, const float m[3][4], const void *in, int instride, int numpoints);
+void Transform_PointsStrided(void *out, int outstride, const mat3x4& m, const void *in, int instride, int numpoints);
+void Transform_VectorsStrided(void *out, int outstride, const mat4x4& m, const void *in, int instride, int numvectors);
+void Transform_VectorsStrided(void *out, int outstride, const float m[3][4], const void *in, int instride, int numvectors);
+void Transform_VectorsStrided(void *out, int outstride, const mat3x4& m, const void *in, int instride, int numvectors);
+
+// structure-of-arrays streams, out->numvectors is set to in->numvectors
+void Transform_PointsSoA(vec3_soa *out, const mat4x4& m, const vec3_soa *in);
+void Transform_PointsSoA(vec3_soa *out, const float m[3][4], const vec3_soa *in);
+void Transform_PointsSoA(vec3_soa *out, const mat3x4& m, const vec3_soa *in);
+void Transform_VectorsSoA(vec3_soa *out, const mat4x4& m, const vec3_soa *in);
+void Transform_VectorsSoA(vec3_soa *out, const float m[3][4], const vec3_soa *in);
+void Transform_VectorsSoA(vec3_soa *out, const mat3x4& m, const vec3_soa *in);
+
+#endif
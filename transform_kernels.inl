@@ -0,0 +1,33 @@
+/*=============================================================================
+	transform_kernels.inl
+
+	per-tier affine transform of component planes, see simd_variants.h. m is
+	the 3x4 row matrix with the translation column already zeroed for
+	vectors. each lane is loaded before it is stored, so out may equal in
+-----------------------------------------------------------------------------*/
+
+static int SIMD_FN(Transform_Kernel)(float *ox, float *oy, float *oz, const float *x, const float *y, const float *z, const float *m, int start, int end)
+{
+	int i;
+
+	vfloat m00 = VF_SET1(m[0]), m01 = VF_SET1(m[1]), m02 = VF_SET1(m[2]), m03 = VF_SET1(m[3]);
+	vfloat m10 = VF_SET1(m[4]), m11 = VF_SET1(m[5]), m12 = VF_SET1(m[6]), m13 = VF_SET1(m[7]);
+	vfloat m20 = VF_SET1(m[8]), m21 = VF_SET1(m[9]), m22 = VF_SET1(m[10]), m23 = VF_SET1(m[11]);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat vx = VF_LOADU(x + i);
+		vfloat vy = VF_LOADU(y + i);
+		vfloat vz = VF_LOADU(z + i);
+
+		vfloat rx = VF_FMADD(m02, vz, VF_FMADD(m01, vy, VF_FMADD(m00, vx, m03)));
+		vfloat ry = VF_FMADD(m12, vz, VF_FMADD(m11, vy, VF_FMADD(m10, vx, m13)));
+		vfloat rz = VF_FMADD(m22, vz, VF_FMADD(m21, vy, VF_FMADD(m20, vx, m23)));
+
+		VF_STOREU(ox + i, rx);
+		VF_STOREU(oy + i, ry);
+		VF_STOREU(oz + i, rz);
+	}
+
+	return i;
+}
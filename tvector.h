@@ -0,0 +1,309 @@
+/*=============================================================================
+	tvector.h
+
+	generic vec<N, T> with float and double instantiations. every operation
+	except Length and Normalize is constexpr (sqrt is not constexpr in C++14).
+	element-wise operations expand over an index sequence so each size
+	compiles to straight-line code with no loop.
+============================================================================*/
+
+#ifndef __TVECTOR_H__
+#define __TVECTOR_H__
+
+#include <math.h>
+#include <utility>
+#include "vector.h"
+
+template<int N, typename T>
+class vec;
+
+/*-----------------------------------------------------------------------------
+	unrolling helpers
+-----------------------------------------------------------------------------*/
+
+template<typename T>
+constexpr T TVec_Sum(T a)
+{
+	return a;
+}
+
+template<typename T, typename... R>
+constexpr T TVec_Sum(T a, R... rest)
+{
+	return a + TVec_Sum(rest...);
+}
+
+constexpr bool TVec_All(bool a)
+{
+	return a;
+}
+
+template<typename... R>
+constexpr bool TVec_All(bool a, R... rest)
+{
+	return a && TVec_All(rest...);
+}
+
+struct TVec_OpAdd { template<typename T> constexpr T operator()(T a, T b) const { return a + b; } };
+struct TVec_OpSub { template<typename T> constexpr T operator()(T a, T b) const { return a - b; } };
+struct TVec_OpMul { template<typename T> constexpr T operator()(T a, T b) const { return a * b; } };
+struct TVec_OpDiv { template<typename T> constexpr T operator()(T a, T b) const { return a / b; } };
+
+template<typename F, int N, typename T, size_t... I>
+constexpr vec<N, T> TVec_Map(F f, const vec<N, T>& a, const vec<N, T>& b, std::index_sequence<I...>)
+{
+	return vec<N, T>(f(a.v[I], b.v[I])...);
+}
+
+template<typename F, int N, typename T, size_t... I>
+constexpr vec<N, T> TVec_MapScalar(F f, const vec<N, T>& a, T s, std::index_sequence<I...>)
+{
+	return vec<N, T>(f(a.v[I], s)...);
+}
+
+template<int N, typename T, size_t... I>
+constexpr T TVec_Dot(const vec<N, T>& a, const vec<N, T>& b, std::index_sequence<I...>)
+{
+	return TVec_Sum((a.v[I] * b.v[I])...);
+}
+
+template<int N, typename T, size_t... I>
+constexpr bool TVec_Equal(const vec<N, T>& a, const vec<N, T>& b, std::index_sequence<I...>)
+{
+	return TVec_All((a.v[I] == b.v[I])...);
+}
+
+template<int N, typename T, typename S, size_t... I>
+constexpr vec<N, T> TVec_Convert(const vec<N, S>& a, std::index_sequence<I...>)
+{
+	return vec<N, T>((T)a.v[I]...);
+}
+
+template<int N, typename T, size_t... I>
+constexpr vec<N, T> TVec_Splat(T s, std::index_sequence<I...>)
+{
+	return vec<N, T>(((void)I, s)...);
+}
+
+/*-----------------------------------------------------------------------------
+	vec<N, T>
+-----------------------------------------------------------------------------*/
+
+template<int N, typename T>
+class vec
+{
+public:
+	typedef std::make_index_sequence<N> indices;
+
+	T	v[N];
+
+	// constructors
+	constexpr vec()
+		: v{}
+	{}
+
+	template<typename... A>
+	constexpr vec(T first, A... rest)
+		: v{ first, (T)rest... }
+	{
+		static_assert(sizeof...(A) + 1 == N, "wrong number of components");
+	}
+
+	static constexpr vec Splat(const T s)
+	{
+		return TVec_Splat<N, T>(s, indices());
+	}
+
+	// convert between float and double
+	template<typename S>
+	static constexpr vec Convert(const vec<N, S>& a)
+	{
+		return TVec_Convert<N, T>(a, indices());
+	}
+
+	constexpr T operator[](int i) const
+	{
+		return v[i];
+	}
+
+	constexpr T& operator[](int i)
+	{
+		return v[i];
+	}
+
+	constexpr T x() const { return v[0]; }
+	constexpr T y() const { static_assert(N > 1, "no y component"); return v[1]; }
+	constexpr T z() const { static_assert(N > 2, "no z component"); return v[2]; }
+	constexpr T w() const { static_assert(N > 3, "no w component"); return v[3]; }
+
+	constexpr vec operator-() const
+	{
+		return TVec_MapScalar(TVec_OpMul(), *this, (T)-1, indices());
+	}
+
+	// functions
+	constexpr bool IsZero() const
+	{
+		return TVec_Equal(*this, vec(), indices());
+	}
+
+	constexpr T LengthSquared() const
+	{
+		return TVec_Dot(*this, *this, indices());
+	}
+
+	T Length() const
+	{
+		return sqrt(LengthSquared());
+	}
+
+	void Normalize()
+	{
+		*this = TVec_MapScalar(TVec_OpMul(), *this, (T)1 / Length(), indices());
+	}
+
+	T* Ptr()
+	{
+		return v;
+	}
+
+	constexpr const T* Ptr() const
+	{
+		return v;
+	}
+};
+
+template<int N, typename T>
+constexpr vec<N, T> operator+(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return TVec_Map(TVec_OpAdd(), a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr vec<N, T> operator-(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return TVec_Map(TVec_OpSub(), a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr vec<N, T> operator*(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return TVec_Map(TVec_OpMul(), a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr vec<N, T> operator/(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return TVec_Map(TVec_OpDiv(), a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr vec<N, T> operator*(const T s, const vec<N, T>& a)
+{
+	return TVec_MapScalar(TVec_OpMul(), a, s, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr vec<N, T> operator*(const vec<N, T>& a, const T s)
+{
+	return TVec_MapScalar(TVec_OpMul(), a, s, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr vec<N, T> operator/(const vec<N, T>& a, const T s)
+{
+	return TVec_MapScalar(TVec_OpMul(), a, (T)1 / s, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr bool operator==(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return TVec_Equal(a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr bool operator!=(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return !TVec_Equal(a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr T Dot(const vec<N, T>& a, const vec<N, T>& b)
+{
+	return TVec_Dot(a, b, std::make_index_sequence<N>());
+}
+
+template<int N, typename T>
+constexpr T LengthSquared(const vec<N, T>& a)
+{
+	return a.LengthSquared();
+}
+
+template<int N, typename T>
+T Length(const vec<N, T>& a)
+{
+	return a.Length();
+}
+
+template<int N, typename T>
+vec<N, T> Normalize(vec<N, T> a)
+{
+	a.Normalize();
+	return a;
+}
+
+template<typename T>
+constexpr vec<3, T> Cross(const vec<3, T>& a, const vec<3, T>& b)
+{
+	return vec<3, T>((a.v[1] * b.v[2]) - (a.v[2] * b.v[1]), (a.v[2] * b.v[0]) - (a.v[0] * b.v[2]), (a.v[0] * b.v[1]) - (a.v[1] * b.v[0]));
+}
+
+/*-----------------------------------------------------------------------------
+	instantiations
+-----------------------------------------------------------------------------*/
+
+typedef vec<2, float>	vec2f;
+typedef vec<3, float>	vec3f;
+typedef vec<4, float>	vec4f;
+typedef vec<2, double>	vec2d;
+typedef vec<3, double>	vec3d;
+typedef vec<4, double>	vec4d;
+
+// conversions to and from the fixed float classes in vector.h
+template<typename T>
+inline vec<2, T> TVec(const vec2& a)
+{
+	return vec<2, T>(a.x, a.y);
+}
+
+template<typename T>
+inline vec<3, T> TVec(const vec3& a)
+{
+	return vec<3, T>(a.x, a.y, a.z);
+}
+
+template<typename T>
+inline vec<4, T> TVec(const vec4& a)
+{
+	return vec<4, T>(a.x, a.y, a.z, a.w);
+}
+
+template<typename T>
+inline vec2 ToVec2(const vec<2, T>& a)
+{
+	return vec2((float)a.v[0], (float)a.v[1]);
+}
+
+template<typename T>
+inline vec3 ToVec3(const vec<3, T>& a)
+{
+	return vec3((float)a.v[0], (float)a.v[1], (float)a.v[2]);
+}
+
+template<typename T>
+inline vec4 ToVec4(const vec<4, T>& a)
+{
+	return vec4((float)a.v[0], (float)a.v[1], (float)a.v[2], (float)a.v[3]);
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include <assert.h>
+#include "vec3soa.h"
+
+#define SIMD_KERNELS "vec3soa_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(Vec3SoA_DotKernel);
+SIMD_DISPATCH(Vec3SoA_CrossKernel);
+SIMD_DISPATCH(Vec3SoA_LengthKernel);
+SIMD_DISPATCH(Vec3SoA_NormalizeKernel);
+SIMD_DISPATCH(Vec3SoA_AddKernel);
+SIMD_DISPATCH(Vec3SoA_SubKernel);
+SIMD_DISPATCH(Vec3SoA_ScaleAddKernel);
+
+static int Vec3SoA_Capacity(int maxvectors)
+{
+	return (maxvectors + VEC3SOA_GRANULARITY - 1) & ~(VEC3SOA_GRANULARITY - 1);
+}
+
+vec3_soa *Vec3SoA_Alloc(int maxvectors)
+{
+	vec3_soa	*v;
+
+	// the header occupies the first alignment block, followed by x, y and z
+	int capacity = Vec3SoA_Capacity(maxvectors);
+	int numbytes = VEC3SOA_ALIGN + (3 * capacity * sizeof(float));
+	v = (vec3_soa*)Simd_AlignedAlloc(numbytes);
+	if(!v)
+		return NULL;
+
+	float *base = (float*)((char*)v + VEC3SOA_ALIGN);
+
+	v->maxvectors	= maxvectors;
+	v->numvectors	= 0;
+	v->x		= base;
+	v->y		= base + capacity;
+	v->z		= base + (2 * capacity);
+
+	return v;
+}
+
+void Vec3SoA_Free(vec3_soa *v)
+{
+	Simd_AlignedFree(v);
+}
+
+void Vec3SoA_FromVec3(vec3_soa *out, const vec3 *in, int numvectors)
+{
+	assert(numvectors <= out->maxvectors);
+
+	for(int i = 0; i < numvectors; i++)
+	{
+		out->x[i] = in[i].x;
+		out->y[i] = in[i].y;
+		out->z[i] = in[i].z;
+	}
+
+	out->numvectors = numvectors;
+}
+
+void Vec3SoA_ToVec3(vec3 *out, const vec3_soa *in)
+{
+	for(int i = 0; i < in->numvectors; i++)
+	{
+		out[i].x = in->x[i];
+		out[i].y = in->y[i];
+		out[i].z = in->z[i];
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	batch functions
+
+	each function runs the kernel for the current simd tier and finishes the
+	remainder with the scalar kernel
+-----------------------------------------------------------------------------*/
+
+static int Vec3SoA_SetCount(vec3_soa *out, const vec3_soa *in)
+{
+	assert(in->numvectors <= out->maxvectors);
+
+	out->numvectors = in->numvectors;
+	return in->numvectors;
+}
+
+void Vec3SoA_Dot(float *out, const vec3_soa *a, const vec3_soa *b)
+{
+	int n = a->numvectors;
+	int i = SIMD_CALL(Vec3SoA_DotKernel)(out, a, b, 0, n);
+
+	Vec3SoA_DotKernel_scalar(out, a, b, i, n);
+}
+
+void Vec3SoA_Cross(vec3_soa *out, const vec3_soa *a, const vec3_soa *b)
+{
+	int n = Vec3SoA_SetCount(out, a);
+	int i = SIMD_CALL(Vec3SoA_CrossKernel)(out, a, b, 0, n);
+
+	Vec3SoA_CrossKernel_scalar(out, a, b, i, n);
+}
+
+void Vec3SoA_LengthSquared(float *out, const vec3_soa *v)
+{
+	Vec3SoA_Dot(out, v, v);
+}
+
+void Vec3SoA_Length(float *out, const vec3_soa *v)
+{
+	int n = v->numvectors;
+	int i = SIMD_CALL(Vec3SoA_LengthKernel)(out, v, 0, n);
+
+	Vec3SoA_LengthKernel_scalar(out, v, i, n);
+}
+
+void Vec3SoA_Normalize(vec3_soa *out, const vec3_soa *v, int precision)
+{
+	int n = Vec3SoA_SetCount(out, v);
+	int i = SIMD_CALL(Vec3SoA_NormalizeKernel)(out, v, precision, 0, n);
+
+	Vec3SoA_NormalizeKernel_scalar(out, v, precision, i, n);
+}
+
+void Vec3SoA_Add(vec3_soa *out, const vec3_soa *a, const vec3_soa *b)
+{
+	int n = Vec3SoA_SetCount(out, a);
+	int i = SIMD_CALL(Vec3SoA_AddKernel)(out, a, b, 0, n);
+
+	Vec3SoA_AddKernel_scalar(out, a, b, i, n);
+}
+
+void Vec3SoA_Sub(vec3_soa *out, const vec3_soa *a, const vec3_soa *b)
+{
+	int n = Vec3SoA_SetCount(out, a);
+	int i = SIMD_CALL(Vec3SoA_SubKernel)(out, a, b, 0, n);
+
+	Vec3SoA_SubKernel_scalar(out, a, b, i, n);
+}
+
+void Vec3SoA_Scale(vec3_soa *out, const vec3_soa *v, float s)
+{
+	int n = Vec3SoA_SetCount(out, v);
+	int i = SIMD_CALL(Vec3SoA_ScaleAddKernel)(out, NULL, s, v, 0, n);
+
+	Vec3SoA_ScaleAddKernel_scalar(out, NULL, s, v, i, n);
+}
+
+void Vec3SoA_ScaleAdd(vec3_soa *out, const vec3_soa *a, float s, const vec3_soa *b)
+{
+	int n = Vec3SoA_SetCount(out, a);
+	int i = SIMD_CALL(Vec3SoA_ScaleAddKernel)(out, a, s, b, 0, n);
+
+	Vec3SoA_ScaleAddKernel_scalar(out, a, s, b, i, n);
+}
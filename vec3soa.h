@@ -0,0 +1,53 @@
+/*=============================================================================
+	vec3soa.h
+============================================================================*/
+
+#ifndef __VEC3SOA_H__
+#define __VEC3SOA_H__
+
+#include "vector.h"
+#include "simd.h"
+
+// the component arrays are allocated with this alignment and the capacity is
+// rounded up so that y and z start on the same boundary as x
+#define VEC3SOA_ALIGN		SIMD_ALIGN
+#define VEC3SOA_GRANULARITY	16
+
+/*-----------------------------------------------------------------------------
+	vec3_soa
+
+	structure-of-arrays stream of vec3s. the batch functions mirror the free
+	functions in vector.h and process numvectors elements of their inputs.
+	outputs may alias inputs.
+-----------------------------------------------------------------------------*/
+
+typedef struct vec3_soa_s
+{
+	int	maxvectors;
+	int	numvectors;
+	float	*x;
+	float	*y;
+	float	*z;
+
+} vec3_soa;
+
+vec3_soa *Vec3SoA_Alloc(int maxvectors);
+void Vec3SoA_Free(vec3_soa *v);
+
+// conversion to and from arrays of vec3 such as polygon_t::vertices
+void Vec3SoA_FromVec3(vec3_soa *out, const vec3 *in, int numvectors);
+void Vec3SoA_ToVec3(vec3 *out, const vec3_soa *in);
+
+void Vec3SoA_Dot(float *out, const vec3_soa *a, const vec3_soa *b);
+void Vec3SoA_Cross(vec3_soa *out, const vec3_soa *a, const vec3_soa *b);
+void Vec3SoA_Length(float *out, const vec3_soa *v);
+void Vec3SoA_LengthSquared(float *out, const vec3_soa *v);
+// precision is one of the NORMALIZE_ tiers in vector.h
+void Vec3SoA_Normalize(vec3_soa *out, const vec3_soa *v, int precision = NORMALIZE_EXACT);
+void Vec3SoA_Add(vec3_soa *out, const vec3_soa *a, const vec3_soa *b);
+void Vec3SoA_Sub(vec3_soa *out, const vec3_soa *a, const vec3_soa *b);
+void Vec3SoA_Scale(vec3_soa *out, const vec3_soa *v, float s);
+// out = a + s * b
+void Vec3SoA_ScaleAdd(vec3_soa *out, const vec3_soa *a, float s, const vec3_soa *b);
+
+#endif
@@ -0,0 +1,142 @@
+/*=============================================================================
+	vec3soa_kernels.inl
+
+	per-tier vec3_soa kernels, see simd_variants.h
+-----------------------------------------------------------------------------*/
+
+static int SIMD_FN(Vec3SoA_DotKernel)(float *out, const vec3_soa *a, const vec3_soa *b, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat r = VF_MUL(VF_LOAD(a->x + i), VF_LOAD(b->x + i));
+		r = VF_FMADD(VF_LOAD(a->y + i), VF_LOAD(b->y + i), r);
+		r = VF_FMADD(VF_LOAD(a->z + i), VF_LOAD(b->z + i), r);
+
+		VF_STOREU(out + i, r);
+	}
+
+	return i;
+}
+
+static int SIMD_FN(Vec3SoA_CrossKernel)(vec3_soa *out, const vec3_soa *a, const vec3_soa *b, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat ax = VF_LOAD(a->x + i), ay = VF_LOAD(a->y + i), az = VF_LOAD(a->z + i);
+		vfloat bx = VF_LOAD(b->x + i), by = VF_LOAD(b->y + i), bz = VF_LOAD(b->z + i);
+
+		VF_STORE(out->x + i, VF_SUB(VF_MUL(ay, bz), VF_MUL(az, by)));
+		VF_STORE(out->y + i, VF_SUB(VF_MUL(az, bx), VF_MUL(ax, bz)));
+		VF_STORE(out->z + i, VF_SUB(VF_MUL(ax, by), VF_MUL(ay, bx)));
+	}
+
+	return i;
+}
+
+static int SIMD_FN(Vec3SoA_LengthKernel)(float *out, const vec3_soa *v, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat x = VF_LOAD(v->x + i), y = VF_LOAD(v->y + i), z = VF_LOAD(v->z + i);
+		vfloat l = VF_FMADD(z, z, VF_FMADD(y, y, VF_MUL(x, x)));
+
+		VF_STOREU(out + i, VF_SQRT(l));
+	}
+
+	return i;
+}
+
+static int SIMD_FN(Vec3SoA_NormalizeKernel)(vec3_soa *out, const vec3_soa *v, int precision, int start, int end)
+{
+	int i;
+	vfloat one = VF_SET1(1.0f);
+	vfloat half = VF_SET1(0.5f);
+	vfloat threehalves = VF_SET1(1.5f);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat x = VF_LOAD(v->x + i), y = VF_LOAD(v->y + i), z = VF_LOAD(v->z + i);
+		vfloat l = VF_FMADD(z, z, VF_FMADD(y, y, VF_MUL(x, x)));
+		vfloat invl;
+
+		if(precision == NORMALIZE_EXACT)
+		{
+			invl = VF_DIV(one, VF_SQRT(l));
+		}
+		else
+		{
+			invl = VF_RSQRT(l);
+
+			if(precision == NORMALIZE_RSQRT_NR)
+			{
+				vfloat hl = VF_MUL(VF_MUL(half, l), invl);
+				invl = VF_MUL(invl, VF_SUB(threehalves, VF_MUL(hl, invl)));
+			}
+		}
+
+		VF_STORE(out->x + i, VF_MUL(x, invl));
+		VF_STORE(out->y + i, VF_MUL(y, invl));
+		VF_STORE(out->z + i, VF_MUL(z, invl));
+	}
+
+	return i;
+}
+
+static int SIMD_FN(Vec3SoA_AddKernel)(vec3_soa *out, const vec3_soa *a, const vec3_soa *b, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		VF_STORE(out->x + i, VF_ADD(VF_LOAD(a->x + i), VF_LOAD(b->x + i)));
+		VF_STORE(out->y + i, VF_ADD(VF_LOAD(a->y + i), VF_LOAD(b->y + i)));
+		VF_STORE(out->z + i, VF_ADD(VF_LOAD(a->z + i), VF_LOAD(b->z + i)));
+	}
+
+	return i;
+}
+
+static int SIMD_FN(Vec3SoA_SubKernel)(vec3_soa *out, const vec3_soa *a, const vec3_soa *b, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		VF_STORE(out->x + i, VF_SUB(VF_LOAD(a->x + i), VF_LOAD(b->x + i)));
+		VF_STORE(out->y + i, VF_SUB(VF_LOAD(a->y + i), VF_LOAD(b->y + i)));
+		VF_STORE(out->z + i, VF_SUB(VF_LOAD(a->z + i), VF_LOAD(b->z + i)));
+	}
+
+	return i;
+}
+
+// out = a + s * b, scale only if a is NULL
+static int SIMD_FN(Vec3SoA_ScaleAddKernel)(vec3_soa *out, const vec3_soa *a, float s, const vec3_soa *b, int start, int end)
+{
+	int i;
+	vfloat vs = VF_SET1(s);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		if(a)
+		{
+			VF_STORE(out->x + i, VF_FMADD(vs, VF_LOAD(b->x + i), VF_LOAD(a->x + i)));
+			VF_STORE(out->y + i, VF_FMADD(vs, VF_LOAD(b->y + i), VF_LOAD(a->y + i)));
+			VF_STORE(out->z + i, VF_FMADD(vs, VF_LOAD(b->z + i), VF_LOAD(a->z + i)));
+		}
+		else
+		{
+			VF_STORE(out->x + i, VF_MUL(vs, VF_LOAD(b->x + i)));
+			VF_STORE(out->y + i, VF_MUL(vs, VF_LOAD(b->y + i)));
+			VF_STORE(out->z + i, VF_MUL(vs, VF_LOAD(b->z + i)));
+		}
+	}
+
+	return i;
+}
@@ -0,0 +1,290 @@
+/*=============================================================================
+	vecexpr.h
+
+	lazy whole-array expressions over vec3 and vec4 arrays. wrapping arrays
+	with VArray builds an expression tree instead of computing anything, and
+	assigning the tree to a VArray evaluates it in one loop with no
+	intermediate buffers:
+
+		VArray(out, n) = VArray(a, n) + t * (VArray(b, n) - VArray(a, n));
+
+	scalar operands are either a float constant or a float array wrapped with
+	SArray, which supplies one scalar per element.
+============================================================================*/
+
+#ifndef __VECEXPR_H__
+#define __VECEXPR_H__
+
+#include <assert.h>
+#include "vector.h"
+
+// tag base so the operators only match expression nodes
+template<typename E>
+class vexpr
+{
+public:
+	const E& Self() const
+	{
+		return static_cast<const E&>(*this);
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	leaves
+-----------------------------------------------------------------------------*/
+
+template<typename V>
+class vexpr_array : public vexpr<vexpr_array<V> >
+{
+public:
+	const V	*p;
+	int	n;
+
+	vexpr_array(const V *p, int n)
+		: p(p), n(n)
+	{}
+
+	V operator[](int i) const
+	{
+		return p[i];
+	}
+
+	int Size() const
+	{
+		return n;
+	}
+};
+
+class vexpr_scalar : public vexpr<vexpr_scalar>
+{
+public:
+	float	s;
+
+	vexpr_scalar(float s)
+		: s(s)
+	{}
+
+	float operator[](int) const
+	{
+		return s;
+	}
+
+	// matches any length
+	int Size() const
+	{
+		return -1;
+	}
+};
+
+class vexpr_scalararray : public vexpr<vexpr_scalararray>
+{
+public:
+	const float	*p;
+	int		n;
+
+	vexpr_scalararray(const float *p, int n)
+		: p(p), n(n)
+	{}
+
+	float operator[](int i) const
+	{
+		return p[i];
+	}
+
+	int Size() const
+	{
+		return n;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	interior nodes
+-----------------------------------------------------------------------------*/
+
+struct vexpr_add { template<typename A, typename B> static auto Apply(const A& a, const B& b) -> decltype(a + b) { return a + b; } };
+struct vexpr_sub { template<typename A, typename B> static auto Apply(const A& a, const B& b) -> decltype(a - b) { return a - b; } };
+struct vexpr_mul { template<typename A, typename B> static auto Apply(const A& a, const B& b) -> decltype(a * b) { return a * b; } };
+struct vexpr_div { template<typename A, typename B> static auto Apply(const A& a, const B& b) -> decltype(a / b) { return a / b; } };
+
+template<typename L, typename R, typename Op>
+class vexpr_binary : public vexpr<vexpr_binary<L, R, Op> >
+{
+public:
+	// children are held by value, leaves are a pointer and a count
+	L	l;
+	R	r;
+
+	vexpr_binary(const L& l, const R& r)
+		: l(l), r(r)
+	{}
+
+	auto operator[](int i) const -> decltype(Op::Apply(l[i], r[i]))
+	{
+		return Op::Apply(l[i], r[i]);
+	}
+
+	int Size() const
+	{
+		int ln = l.Size();
+		int rn = r.Size();
+
+		assert(ln < 0 || rn < 0 || ln == rn);
+		return (ln >= 0) ? ln : rn;
+	}
+};
+
+template<typename E>
+class vexpr_negate : public vexpr<vexpr_negate<E> >
+{
+public:
+	E	e;
+
+	vexpr_negate(const E& e)
+		: e(e)
+	{}
+
+	auto operator[](int i) const -> decltype(-e[i])
+	{
+		return -e[i];
+	}
+
+	int Size() const
+	{
+		return e.Size();
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	varray
+
+	assignable view of an array. also usable as an operand
+-----------------------------------------------------------------------------*/
+
+template<typename V>
+class varray : public vexpr<varray<V> >
+{
+public:
+	V	*p;
+	int	n;
+
+	varray(V *p, int n)
+		: p(p), n(n)
+	{}
+
+	// declared because operator= is, operands are held by value
+	varray(const varray& a)
+		: p(a.p), n(a.n)
+	{}
+
+	V operator[](int i) const
+	{
+		return p[i];
+	}
+
+	int Size() const
+	{
+		return n;
+	}
+
+	// evaluate the whole tree one element at a time. the output may alias
+	// an operand since each element only reads its own index
+	template<typename E>
+	varray& operator=(const vexpr<E>& expr)
+	{
+		const E& e = expr.Self();
+
+		assert(e.Size() < 0 || e.Size() == n);
+
+		for(int i = 0; i < n; i++)
+		{
+			p[i] = e[i];
+		}
+
+		return *this;
+	}
+
+	varray& operator=(const varray& a)
+	{
+		return operator=<varray>(a);
+	}
+
+	template<typename E>
+	varray& operator+=(const vexpr<E>& expr)
+	{
+		const E& e = expr.Self();
+
+		assert(e.Size() < 0 || e.Size() == n);
+
+		for(int i = 0; i < n; i++)
+		{
+			p[i] = p[i] + e[i];
+		}
+
+		return *this;
+	}
+};
+
+template<typename V>
+inline varray<V> VArray(V *p, int n)
+{
+	return varray<V>(p, n);
+}
+
+template<typename V>
+inline vexpr_array<V> VArray(const V *p, int n)
+{
+	return vexpr_array<V>(p, n);
+}
+
+inline vexpr_scalararray SArray(const float *p, int n)
+{
+	return vexpr_scalararray(p, n);
+}
+
+/*-----------------------------------------------------------------------------
+	operators
+-----------------------------------------------------------------------------*/
+
+template<typename A, typename B>
+inline vexpr_binary<A, B, vexpr_add> operator+(const vexpr<A>& a, const vexpr<B>& b)
+{
+	return vexpr_binary<A, B, vexpr_add>(a.Self(), b.Self());
+}
+
+template<typename A, typename B>
+inline vexpr_binary<A, B, vexpr_sub> operator-(const vexpr<A>& a, const vexpr<B>& b)
+{
+	return vexpr_binary<A, B, vexpr_sub>(a.Self(), b.Self());
+}
+
+template<typename A, typename B>
+inline vexpr_binary<A, B, vexpr_mul> operator*(const vexpr<A>& a, const vexpr<B>& b)
+{
+	return vexpr_binary<A, B, vexpr_mul>(a.Self(), b.Self());
+}
+
+template<typename A>
+inline vexpr_binary<vexpr_scalar, A, vexpr_mul> operator*(const float s, const vexpr<A>& a)
+{
+	return vexpr_binary<vexpr_scalar, A, vexpr_mul>(vexpr_scalar(s), a.Self());
+}
+
+template<typename A>
+inline vexpr_binary<A, vexpr_scalar, vexpr_mul> operator*(const vexpr<A>& a, const float s)
+{
+	return vexpr_binary<A, vexpr_scalar, vexpr_mul>(a.Self(), vexpr_scalar(s));
+}
+
+template<typename A>
+inline vexpr_binary<A, vexpr_scalar, vexpr_div> operator/(const vexpr<A>& a, const float s)
+{
+	return vexpr_binary<A, vexpr_scalar, vexpr_div>(a.Self(), vexpr_scalar(s));
+}
+
+template<typename A>
+inline vexpr_negate<A> operator-(const vexpr<A>& a)
+{
+	return vexpr_negate<A>(a.Self());
+}
+
+#endif
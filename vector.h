@@ -10,6 +10,59 @@
 
 #include <math.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define VECTOR_SSE
+#include <xmmintrin.h>
+#if defined(__FMA__)
+#define VECTOR_FMA
+#include <immintrin.h>
+#endif
+#endif
+
+/*-----------------------------------------------------------------------------
+	normalization precision
+
+	max relative error of the reciprocal length for each tier:
+
+	NORMALIZE_EXACT		1 / sqrtf, correctly rounded divide and sqrt
+	NORMALIZE_RSQRT_NR	hardware estimate and one newton step, 5e-7
+	NORMALIZE_RSQRT		hardware estimate, 3.7e-4 (sse, avx2) or
+				6.1e-5 (avx512 batch kernels)
+
+	without sse the estimate comes from the integer approximation refined
+	once, giving 1.8e-3 for NORMALIZE_RSQRT and 5e-6 for NORMALIZE_RSQRT_NR
+-----------------------------------------------------------------------------*/
+
+#define NORMALIZE_EXACT		0
+#define NORMALIZE_RSQRT_NR	1
+#define NORMALIZE_RSQRT		2
+
+inline float InvSqrt(const float x, const int precision = NORMALIZE_EXACT)
+{
+	if(precision == NORMALIZE_EXACT)
+	{
+		return 1.0f / sqrtf(x);
+	}
+
+#ifdef VECTOR_SSE
+	float r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+	union { float f; unsigned int i; } u;
+
+	u.f = x;
+	u.i = 0x5f3759df - (u.i >> 1);
+
+	float r = u.f * (1.5f - (0.5f * x * u.f * u.f));
+#endif
+
+	if(precision == NORMALIZE_RSQRT_NR)
+	{
+		r = r * (1.5f - (0.5f * x * r * r));
+	}
+
+	return r;
+}
+
 /*-----------------------------------------------------------------------------
 	vec2
 -----------------------------------------------------------------------------*/
@@ -35,7 +88,7 @@ public:
 	void MakeZero();
 	bool IsZero();
 	bool IsNearlyZero();
-	void Normalize();
+	void Normalize(const int precision = NORMALIZE_EXACT);
 	float Length();
 	float LengthSquared();
 	float Dot(const vec2& v) const;
@@ -97,9 +150,9 @@ inline bool vec2::IsNearlyZero()
 	return((x < EPSILON_E4) && (y < EPSILON_E4));
 }
 
-inline void vec2::Normalize()
+inline void vec2::Normalize(const int precision)
 {
-	float invl = 1.0f / sqrtf((x * x) + (y * y));
+	float invl = InvSqrt((x * x) + (y * y), precision);
 	
 	x *= invl;
 	y *= invl;
@@ -207,9 +260,9 @@ inline float Dot(const vec2 a, const vec2 b)
 	return (a.x * b.x) + (a.y * b.y);
 }
 
-inline vec2 Normalize(vec2 v)
+inline vec2 Normalize(vec2 v, const int precision = NORMALIZE_EXACT)
 {
-	v. Normalize();
+	v.Normalize(precision);
 	return v;
 }
 
@@ -246,7 +299,7 @@ public:
 	void MakeZero();
 	bool IsZero();
 	bool IsNearlyZero();
-	void Normalize();
+	void Normalize(const int precision = NORMALIZE_EXACT);
 	float Length();
 	float LengthSquared();
 	float* Ptr();
@@ -307,9 +360,9 @@ inline bool vec3::IsNearlyZero()
 	return (x < EPSILON_E4) && (y < EPSILON_E4) && (z < EPSILON_E4);
 }
 
-inline void vec3::Normalize()
+inline void vec3::Normalize(const int precision)
 {
-	float invl = 1.0f / sqrtf((x * x) + (y * y) + (z * z));
+	float invl = InvSqrt((x * x) + (y * y) + (z * z), precision);
 	
 	x *= invl;
 	y *= invl;
@@ -427,9 +480,9 @@ inline vec3 Cross(const vec3& a, const vec3& b)
 	return vec3((a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x));
 }
 
-inline vec3 Normalize(vec3 v)
+inline vec3 Normalize(vec3 v, const int precision = NORMALIZE_EXACT)
 {
-	v.Normalize();
+	v.Normalize(precision);
 	return v;
 }
 
@@ -437,19 +490,39 @@ static vec3 vec3_zero = vec3(0.0f, 0.0f, 0.0f);
 
 /*-----------------------------------------------------------------------------
 	vec4
+
+	with sse the components share storage with an __m128 so the arithmetic
+	operators compile to single instructions
 -----------------------------------------------------------------------------*/
 
 class vec4
 {
 public:
+#ifdef VECTOR_SSE
+	union
+	{
+		struct
+		{
+			float	x;
+			float	y;
+			float	z;
+			float	w;
+		};
+		__m128	v;
+	};
+#else
 	float	x;
 	float	y;
 	float	z;
 	float	w;
+#endif
 			
 	// constructors
 	vec4();
 	vec4(const float x, const float y, const float z, const float w);
+#ifdef VECTOR_SSE
+	vec4(const __m128 v);
+#endif
 
 	operator float*();
 	float operator[](int i) const;
@@ -462,7 +535,7 @@ public:
 	void MakeZero();
 	bool IsZero();
 	bool IsNearlyZero();
-	void Normalize();
+	void Normalize(const int precision = NORMALIZE_EXACT);
 	float Length();
 	float LengthSquared();
 	float* Ptr();
@@ -472,9 +545,19 @@ public:
 inline vec4::vec4()
 {}
 
+#ifdef VECTOR_SSE
+inline vec4::vec4(const float x, const float y, const float z, const float w)
+	: v(_mm_setr_ps(x, y, z, w))
+{}
+
+inline vec4::vec4(const __m128 v)
+	: v(v)
+{}
+#else
 inline vec4::vec4(const float x, const float y, const float z, const float w)
 	: x(x), y(y), z(z), w(w)
 {}
+#endif
 
 inline vec4::operator float*()
 {
@@ -495,7 +578,11 @@ inline float& vec4::operator[](int i)
 // unary operators
 inline vec4 vec4::operator-() const
 {
+#ifdef VECTOR_SSE
+	return vec4(_mm_sub_ps(_mm_setzero_ps(), v));
+#else
 	return vec4(-x, -y, -z, -w);
+#endif
 }
 
 // functions
@@ -525,9 +612,9 @@ inline bool vec4::IsNearlyZero()
 	return (x < EPSILON_E4) && (y < EPSILON_E4) && (z < EPSILON_E4);
 }
 
-inline void vec4::Normalize()
+inline void vec4::Normalize(const int precision)
 {
-	float invl = 1.0f / sqrtf((x * x) + (y * y) + (z * z) + (w * w));
+	float invl = InvSqrt((x * x) + (y * y) + (z * z) + (w * w), precision);
 	
 	x *= invl;
 	y *= invl;
@@ -557,6 +644,9 @@ inline const float* vec4::Ptr() const
 
 inline vec4 operator+(const vec4 a, const vec4 b)
 {
+#ifdef VECTOR_SSE
+	return vec4(_mm_add_ps(a.v, b.v));
+#else
 	vec4 r;
 
 	r.x = a.x + b.x;
@@ -565,10 +655,14 @@ inline vec4 operator+(const vec4 a, const vec4 b)
 	r.w = a.w + b.w;
 
 	return r;
+#endif
 }
 
 inline vec4 operator-(const vec4 a, const vec4 b)
 {
+#ifdef VECTOR_SSE
+	return vec4(_mm_sub_ps(a.v, b.v));
+#else
 	vec4 r;
 
 	r.x = a.x - b.x;
@@ -577,10 +671,14 @@ inline vec4 operator-(const vec4 a, const vec4 b)
 	r.w = a.w - b.w;
 
 	return r;
+#endif
 }
 
 inline vec4 operator*(const vec4 a, const vec4 b)
 {
+#ifdef VECTOR_SSE
+	return vec4(_mm_mul_ps(a.v, b.v));
+#else
 	vec4 r;
 
 	r.x = a.x * b.x;
@@ -589,15 +687,23 @@ inline vec4 operator*(const vec4 a, const vec4 b)
 	r.w = a.w * b.w;
 
 	return r;
+#endif
 }
 
 inline vec4 operator/(const vec4 a, const vec4 b)
 {
+#ifdef VECTOR_SSE
+	return vec4(_mm_div_ps(a.v, b.v));
+#else
 	return vec4(a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w);
+#endif
 }
 
 inline vec4 operator*(const float s, const vec4 v)
 {
+#ifdef VECTOR_SSE
+	return vec4(_mm_mul_ps(_mm_set1_ps(s), v.v));
+#else
 	vec4 r;
 
 	r.x = s * v.x;
@@ -606,6 +712,7 @@ inline vec4 operator*(const float s, const vec4 v)
 	r.w = s * v.w;
 
 	return r;
+#endif
 }
 
 inline vec4 operator*(const vec4 v, const float s)
@@ -644,12 +751,24 @@ inline float Dot(const vec4 a, const vec4 b)
 	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
 }
 
-inline vec4 Normalize(vec4 v)
+inline vec4 Normalize(vec4 v, const int precision = NORMALIZE_EXACT)
 {
-	v.Normalize();
+	v.Normalize(precision);
 	return v;
 }
 
+// a + (s * b), fused when the target has fma
+inline vec4 MulAdd(const vec4 a, const float s, const vec4 b)
+{
+#if defined(VECTOR_FMA)
+	return vec4(_mm_fmadd_ps(_mm_set1_ps(s), b.v, a.v));
+#elif defined(VECTOR_SSE)
+	return vec4(_mm_add_ps(a.v, _mm_mul_ps(_mm_set1_ps(s), b.v)));
+#else
+	return a + (s * b);
+#endif
+}
+
 static vec4 vec4_zero(0.0f, 0.0f, 0.0f, 0.0f);
 
 #endif
@@ -0,0 +1,327 @@
+#include <assert.h>
+#include "vertexstream.h"
+#include "bounds.h"
+
+/*-----------------------------------------------------------------------------
+	half precision conversion, round to nearest even
+-----------------------------------------------------------------------------*/
+
+typedef union
+{
+	float		f;
+	unsigned int	u;
+} vertexstream_bits_t;
+
+static float VertexStream_HalfToFloat(unsigned short h)
+{
+	vertexstream_bits_t	o, magic;
+	unsigned int		shiftedexp = 0x7c00 << 13;
+
+	magic.u = 113 << 23;
+
+	o.u = (h & 0x7fff) << 13;
+	unsigned int exp = o.u & shiftedexp;
+	o.u += (127 - 15) << 23;
+
+	if(exp == shiftedexp)
+	{
+		// inf or nan
+		o.u += (128 - 16) << 23;
+	}
+	else if(exp == 0)
+	{
+		// denormal, renormalize through the fpu
+		o.u += 1 << 23;
+		o.f -= magic.f;
+	}
+
+	o.u |= (h & 0x8000) << 16;
+
+	return o.f;
+}
+
+static unsigned short VertexStream_FloatToHalf(float f)
+{
+	vertexstream_bits_t	v, denormmagic;
+	unsigned int		o;
+
+	denormmagic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+
+	v.f = f;
+	unsigned int sign = v.u & 0x80000000;
+	v.u ^= sign;
+
+	if(v.u >= (127 + 16) << 23)
+	{
+		// overflow to inf, nan stays nan
+		o = (v.u > 0x7f800000) ? 0x7e00 : 0x7c00;
+	}
+	else if(v.u < (113 << 23))
+	{
+		// denormal or zero, let the fpu do the rounding
+		v.f += denormmagic.f;
+		o = v.u - denormmagic.u;
+	}
+	else
+	{
+		unsigned int mantodd = (v.u >> 13) & 1;
+
+		v.u += ((unsigned int)(15 - 127) << 23) + 0xfff;
+		v.u += mantodd;
+		o = v.u >> 13;
+	}
+
+	return (unsigned short)(o | (sign >> 16));
+}
+
+#define SIMD_KERNELS "vertexstream_kernels.inl"
+#include "simd_variants.h"
+
+SIMD_DISPATCH(VertexStream_DecodeHalfKernel);
+SIMD_DISPATCH(VertexStream_EncodeHalfKernel);
+SIMD_DISPATCH(VertexStream_DecodeUnormKernel);
+SIMD_DISPATCH(VertexStream_EncodeUnormKernel);
+SIMD_DISPATCH(VertexStream_DecodeOctKernel);
+SIMD_DISPATCH(VertexStream_EncodeOctKernel);
+
+// vertices converted per pass when going through vec3 arrays
+#define VERTEXSTREAM_BLOCK	256
+
+/*-----------------------------------------------------------------------------
+	allocation
+-----------------------------------------------------------------------------*/
+
+static int VertexStream_NumPlanes(int format)
+{
+	return (format == VERTEXSTREAM_OCTNORMAL) ? 2 : 3;
+}
+
+int VertexStream_BytesPerVertex(int format)
+{
+	return VertexStream_NumPlanes(format) * sizeof(unsigned short);
+}
+
+vertexstream_t *VertexStream_Alloc(int format, int maxvertices)
+{
+	vertexstream_t	*s;
+
+	// planes start on simd alignment boundaries after the header
+	int headerbytes = (sizeof(vertexstream_t) + SIMD_ALIGN - 1) & ~(SIMD_ALIGN - 1);
+	int planebytes = ((maxvertices * sizeof(unsigned short)) + SIMD_ALIGN - 1) & ~(SIMD_ALIGN - 1);
+	int numplanes = VertexStream_NumPlanes(format);
+
+	s = (vertexstream_t*)Simd_AlignedAlloc(headerbytes + (numplanes * planebytes));
+	if(!s)
+		return NULL;
+
+	s->format	= format;
+	s->maxvertices	= maxvertices;
+	s->numvertices	= 0;
+	s->bmin		= vec3_zero;
+	s->bmax		= vec3_zero;
+
+	for(int i = 0; i < 3; i++)
+	{
+		s->c[i] = (i < numplanes) ? (unsigned short*)((char*)s + headerbytes + (i * planebytes)) : NULL;
+	}
+
+	return s;
+}
+
+void VertexStream_Free(vertexstream_t *s)
+{
+	Simd_AlignedFree(s);
+}
+
+/*-----------------------------------------------------------------------------
+	planar encode and decode
+
+	the stream element range [start, start + count) to or from float planes
+-----------------------------------------------------------------------------*/
+
+// quant16 scale and bias for one axis
+static void VertexStream_QuantAxis(const vertexstream_t *s, int axis, float *scale, float *bias)
+{
+	float extent = s->bmax[axis] - s->bmin[axis];
+
+	*scale	= extent / 65535.0f;
+	*bias	= s->bmin[axis];
+}
+
+static void VertexStream_EncodePlanes(vertexstream_t *s, const float *x, const float *y, const float *z, int start, int count)
+{
+	const float	*in[3] = { x, y, z };
+	int		n = count;
+
+	if(s->format == VERTEXSTREAM_OCTNORMAL)
+	{
+		unsigned short *u = s->c[0] + start;
+		unsigned short *v = s->c[1] + start;
+
+		int i = SIMD_CALL(VertexStream_EncodeOctKernel)(u, v, x, y, z, 0, n);
+		VertexStream_EncodeOctKernel_scalar(u, v, x, y, z, i, n);
+		return;
+	}
+
+	for(int j = 0; j < 3; j++)
+	{
+		unsigned short *out = s->c[j] + start;
+
+		if(s->format == VERTEXSTREAM_HALF)
+		{
+			int i = SIMD_CALL(VertexStream_EncodeHalfKernel)(out, in[j], 0, n);
+			VertexStream_EncodeHalfKernel_scalar(out, in[j], i, n);
+		}
+		else
+		{
+			float scale, bias;
+
+			VertexStream_QuantAxis(s, j, &scale, &bias);
+			scale = (scale > 0.0f) ? (1.0f / scale) : 0.0f;
+
+			int i = SIMD_CALL(VertexStream_EncodeUnormKernel)(out, in[j], scale, bias, 0, n);
+			VertexStream_EncodeUnormKernel_scalar(out, in[j], scale, bias, i, n);
+		}
+	}
+}
+
+static void VertexStream_DecodePlanes(float *x, float *y, float *z, const vertexstream_t *s, int start, int count)
+{
+	float	*out[3] = { x, y, z };
+	int	n = count;
+
+	if(s->format == VERTEXSTREAM_OCTNORMAL)
+	{
+		const unsigned short *u = s->c[0] + start;
+		const unsigned short *v = s->c[1] + start;
+
+		int i = SIMD_CALL(VertexStream_DecodeOctKernel)(x, y, z, u, v, 0, n);
+		VertexStream_DecodeOctKernel_scalar(x, y, z, u, v, i, n);
+		return;
+	}
+
+	for(int j = 0; j < 3; j++)
+	{
+		const unsigned short *in = s->c[j] + start;
+
+		if(s->format == VERTEXSTREAM_HALF)
+		{
+			int i = SIMD_CALL(VertexStream_DecodeHalfKernel)(out[j], in, 0, n);
+			VertexStream_DecodeHalfKernel_scalar(out[j], in, i, n);
+		}
+		else
+		{
+			float scale, bias;
+
+			VertexStream_QuantAxis(s, j, &scale, &bias);
+
+			int i = SIMD_CALL(VertexStream_DecodeUnormKernel)(out[j], in, scale, bias, 0, n);
+			VertexStream_DecodeUnormKernel_scalar(out[j], in, scale, bias, i, n);
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	public interface
+-----------------------------------------------------------------------------*/
+
+// quant16 bounds. an empty stream gets a zero box rather than the inverted one
+static void VertexStream_FitBounds(vertexstream_t *s, const vec3 *in, int numvertices)
+{
+	Bounds_FromPoints(in, numvertices, &s->bmin, &s->bmax);
+
+	if(!numvertices)
+	{
+		s->bmin = vec3_zero;
+		s->bmax = vec3_zero;
+	}
+}
+
+static void VertexStream_FitBoundsSoA(vertexstream_t *s, const vec3_soa *in)
+{
+	Bounds_FromSoA(in, &s->bmin, &s->bmax);
+
+	if(!in->numvectors)
+	{
+		s->bmin = vec3_zero;
+		s->bmax = vec3_zero;
+	}
+}
+
+void VertexStream_EncodeSoA(vertexstream_t *s, const vec3_soa *in)
+{
+	assert(in->numvectors <= s->maxvertices);
+
+	if(s->format == VERTEXSTREAM_QUANT16)
+	{
+		VertexStream_FitBoundsSoA(s, in);
+	}
+
+	VertexStream_EncodePlanes(s, in->x, in->y, in->z, 0, in->numvectors);
+	s->numvertices = in->numvectors;
+}
+
+void VertexStream_Encode(vertexstream_t *s, const vec3 *in, int numvertices)
+{
+	float	x[VERTEXSTREAM_BLOCK];
+	float	y[VERTEXSTREAM_BLOCK];
+	float	z[VERTEXSTREAM_BLOCK];
+
+	assert(numvertices <= s->maxvertices);
+
+	if(s->format == VERTEXSTREAM_QUANT16)
+	{
+		VertexStream_FitBounds(s, in, numvertices);
+	}
+
+	// deinterleave a block at a time
+	for(int start = 0; start < numvertices; start += VERTEXSTREAM_BLOCK)
+	{
+		int count = numvertices - start;
+		if(count > VERTEXSTREAM_BLOCK)
+			count = VERTEXSTREAM_BLOCK;
+
+		for(int i = 0; i < count; i++)
+		{
+			x[i] = in[start + i].x;
+			y[i] = in[start + i].y;
+			z[i] = in[start + i].z;
+		}
+
+		VertexStream_EncodePlanes(s, x, y, z, start, count);
+	}
+
+	s->numvertices = numvertices;
+}
+
+void VertexStream_DecodeSoA(vec3_soa *out, const vertexstream_t *s)
+{
+	assert(s->numvertices <= out->maxvectors);
+
+	VertexStream_DecodePlanes(out->x, out->y, out->z, s, 0, s->numvertices);
+	out->numvectors = s->numvertices;
+}
+
+void VertexStream_Decode(vec3 *out, const vertexstream_t *s)
+{
+	float	x[VERTEXSTREAM_BLOCK];
+	float	y[VERTEXSTREAM_BLOCK];
+	float	z[VERTEXSTREAM_BLOCK];
+
+	// decode a block into planes and interleave it
+	for(int start = 0; start < s->numvertices; start += VERTEXSTREAM_BLOCK)
+	{
+		int count = s->numvertices - start;
+		if(count > VERTEXSTREAM_BLOCK)
+			count = VERTEXSTREAM_BLOCK;
+
+		VertexStream_DecodePlanes(x, y, z, s, start, count);
+
+		for(int i = 0; i < count; i++)
+		{
+			out[start + i].x = x[i];
+			out[start + i].y = y[i];
+			out[start + i].z = z[i];
+		}
+	}
+}
@@ -0,0 +1,45 @@
+/*=============================================================================
+	vertexstream.h
+============================================================================*/
+
+#ifndef __VERTEXSTREAM_H__
+#define __VERTEXSTREAM_H__
+
+#include "vector.h"
+#include "vec3soa.h"
+
+// storage formats. components are stored in separate 16 bit planes so the
+// bulk decoders can convert a full simd register per load
+#define VERTEXSTREAM_HALF	0	// fp16 x, y, z, 6 bytes per vertex
+#define VERTEXSTREAM_QUANT16	1	// x, y, z as 16 bit fractions of the bounds, 6 bytes
+#define VERTEXSTREAM_OCTNORMAL	2	// unit vectors as octahedral u, v snorm16, 4 bytes
+
+typedef struct vertexstream_s
+{
+	int	format;
+	int	maxvertices;
+	int	numvertices;
+
+	// VERTEXSTREAM_QUANT16 only, set by VertexStream_Encode
+	vec3	bmin;
+	vec3	bmax;
+
+	// component planes, c[2] is unused for VERTEXSTREAM_OCTNORMAL
+	unsigned short	*c[3];
+
+} vertexstream_t;
+
+vertexstream_t *VertexStream_Alloc(int format, int maxvertices);
+void VertexStream_Free(vertexstream_t *s);
+int VertexStream_BytesPerVertex(int format);
+
+// compress numvertices vectors into the stream. QUANT16 fits the bounds to
+// the input, OCTNORMAL expects unit length input
+void VertexStream_Encode(vertexstream_t *s, const vec3 *in, int numvertices);
+void VertexStream_EncodeSoA(vertexstream_t *s, const vec3_soa *in);
+
+// decompress the whole stream. out must hold numvertices elements
+void VertexStream_Decode(vec3 *out, const vertexstream_t *s);
+void VertexStream_DecodeSoA(vec3_soa *out, const vertexstream_t *s);
+
+#endif
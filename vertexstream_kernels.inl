@@ -0,0 +1,300 @@
+/*=============================================================================
+	vertexstream_kernels.inl
+
+	per-tier vertex stream kernels, see simd_variants.h. each kernel converts
+	one component plane between 16 bit storage and floats
+-----------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------
+	16 bit lane conversions
+-----------------------------------------------------------------------------*/
+
+#if SIMD_BUILD_TIER == SIMD_TIER_SCALAR
+
+static inline vfloat SIMD_FN(VertexStream_LoadU16)(const unsigned short *p)
+{
+	return (float)p[0];
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadS16)(const unsigned short *p)
+{
+	return (float)(short)p[0];
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadF16)(const unsigned short *p)
+{
+	return VertexStream_HalfToFloat(p[0]);
+}
+
+static inline void SIMD_FN(VertexStream_StoreU16)(unsigned short *p, vfloat v)
+{
+	p[0] = (unsigned short)lrintf(v);
+}
+
+static inline void SIMD_FN(VertexStream_StoreS16)(unsigned short *p, vfloat v)
+{
+	p[0] = (unsigned short)(short)lrintf(v);
+}
+
+static inline void SIMD_FN(VertexStream_StoreF16)(unsigned short *p, vfloat v)
+{
+	p[0] = VertexStream_FloatToHalf(v);
+}
+
+#elif SIMD_BUILD_TIER == SIMD_TIER_SSE2
+
+static inline vfloat SIMD_FN(VertexStream_LoadU16)(const unsigned short *p)
+{
+	__m128i h = _mm_loadl_epi64((const __m128i*)p);
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(h, _mm_setzero_si128()));
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadS16)(const unsigned short *p)
+{
+	__m128i h = _mm_loadl_epi64((const __m128i*)p);
+	return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(h, h), 16));
+}
+
+// same steps as VertexStream_HalfToFloat on four lanes
+static inline vfloat SIMD_FN(VertexStream_LoadF16)(const unsigned short *p)
+{
+	__m128i h = _mm_loadl_epi64((const __m128i*)p);
+	h = _mm_unpacklo_epi16(h, _mm_setzero_si128());
+
+	__m128i shiftedexp = _mm_set1_epi32(0x7c00 << 13);
+	__m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+	__m128i exp = _mm_and_si128(o, shiftedexp);
+	o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+
+	// inf and nan keep an all ones exponent
+	__m128i infnan = _mm_cmpeq_epi32(exp, shiftedexp);
+	o = _mm_add_epi32(o, _mm_and_si128(infnan, _mm_set1_epi32((128 - 16) << 23)));
+
+	// denormals are renormalized by the fpu
+	__m128i denorm = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+	__m128 magic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+	__m128 d = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))), magic);
+	__m128 f = VF_SELECT(_mm_castsi128_ps(denorm), d, _mm_castsi128_ps(o));
+
+	__m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+	return _mm_or_ps(f, _mm_castsi128_ps(sign));
+}
+
+static inline void SIMD_FN(VertexStream_StoreU16)(unsigned short *p, vfloat v)
+{
+	// sse2 only has a signed pack, so bias into signed range and back
+	__m128i i = _mm_sub_epi32(_mm_cvtps_epi32(v), _mm_set1_epi32(32768));
+	__m128i h = _mm_xor_si128(_mm_packs_epi32(i, i), _mm_set1_epi16((short)0x8000));
+	_mm_storel_epi64((__m128i*)p, h);
+}
+
+static inline void SIMD_FN(VertexStream_StoreS16)(unsigned short *p, vfloat v)
+{
+	__m128i i = _mm_cvtps_epi32(v);
+	_mm_storel_epi64((__m128i*)p, _mm_packs_epi32(i, i));
+}
+
+static inline void SIMD_FN(VertexStream_StoreF16)(unsigned short *p, vfloat v)
+{
+	float f[4];
+
+	_mm_storeu_ps(f, v);
+	for(int i = 0; i < 4; i++)
+		p[i] = VertexStream_FloatToHalf(f[i]);
+}
+
+#elif SIMD_BUILD_TIER == SIMD_TIER_AVX2
+
+static inline vfloat SIMD_FN(VertexStream_LoadU16)(const unsigned short *p)
+{
+	return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p)));
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadS16)(const unsigned short *p)
+{
+	return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p)));
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadF16)(const unsigned short *p)
+{
+	return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p));
+}
+
+static inline void SIMD_FN(VertexStream_StoreU16)(unsigned short *p, vfloat v)
+{
+	__m256i i = _mm256_cvtps_epi32(v);
+	_mm_storeu_si128((__m128i*)p, _mm_packus_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+}
+
+static inline void SIMD_FN(VertexStream_StoreS16)(unsigned short *p, vfloat v)
+{
+	__m256i i = _mm256_cvtps_epi32(v);
+	_mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+}
+
+static inline void SIMD_FN(VertexStream_StoreF16)(unsigned short *p, vfloat v)
+{
+	_mm_storeu_si128((__m128i*)p, _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+#elif SIMD_BUILD_TIER == SIMD_TIER_AVX512
+
+static inline vfloat SIMD_FN(VertexStream_LoadU16)(const unsigned short *p)
+{
+	return _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)p)));
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadS16)(const unsigned short *p)
+{
+	return _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)p)));
+}
+
+static inline vfloat SIMD_FN(VertexStream_LoadF16)(const unsigned short *p)
+{
+	return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)p));
+}
+
+static inline void SIMD_FN(VertexStream_StoreU16)(unsigned short *p, vfloat v)
+{
+	_mm256_storeu_si256((__m256i*)p, _mm512_cvtusepi32_epi16(_mm512_cvtps_epu32(v)));
+}
+
+static inline void SIMD_FN(VertexStream_StoreS16)(unsigned short *p, vfloat v)
+{
+	_mm256_storeu_si256((__m256i*)p, _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(v)));
+}
+
+static inline void SIMD_FN(VertexStream_StoreF16)(unsigned short *p, vfloat v)
+{
+	_mm256_storeu_si256((__m256i*)p, _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+#endif
+
+/*-----------------------------------------------------------------------------
+	plane kernels
+-----------------------------------------------------------------------------*/
+
+static int SIMD_FN(VertexStream_DecodeHalfKernel)(float *out, const unsigned short *in, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		VF_STOREU(out + i, SIMD_FN(VertexStream_LoadF16)(in + i));
+	}
+
+	return i;
+}
+
+static int SIMD_FN(VertexStream_EncodeHalfKernel)(unsigned short *out, const float *in, int start, int end)
+{
+	int i;
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		SIMD_FN(VertexStream_StoreF16)(out + i, VF_LOADU(in + i));
+	}
+
+	return i;
+}
+
+// out = bias + q * scale
+static int SIMD_FN(VertexStream_DecodeUnormKernel)(float *out, const unsigned short *in, float scale, float bias, int start, int end)
+{
+	int i;
+	vfloat vs = VF_SET1(scale);
+	vfloat vb = VF_SET1(bias);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		VF_STOREU(out + i, VF_FMADD(SIMD_FN(VertexStream_LoadU16)(in + i), vs, vb));
+	}
+
+	return i;
+}
+
+// q = (in - bias) * scale, clamped to the 16 bit range
+static int SIMD_FN(VertexStream_EncodeUnormKernel)(unsigned short *out, const float *in, float scale, float bias, int start, int end)
+{
+	int i;
+	vfloat vs = VF_SET1(scale);
+	vfloat vb = VF_SET1(bias);
+	vfloat vmax = VF_SET1(65535.0f);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat q = VF_MUL(VF_SUB(VF_LOADU(in + i), vb), vs);
+		q = VF_MIN(VF_MAX(q, VF_ZERO()), vmax);
+
+		SIMD_FN(VertexStream_StoreU16)(out + i, q);
+	}
+
+	return i;
+}
+
+static int SIMD_FN(VertexStream_DecodeOctKernel)(float *x, float *y, float *z, const unsigned short *u, const unsigned short *v, int start, int end)
+{
+	int i;
+	vfloat one = VF_SET1(1.0f);
+	vfloat snorm = VF_SET1(1.0f / 32767.0f);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat fx = VF_MUL(SIMD_FN(VertexStream_LoadS16)(u + i), snorm);
+		vfloat fy = VF_MUL(SIMD_FN(VertexStream_LoadS16)(v + i), snorm);
+		vfloat fz = VF_SUB(VF_SUB(one, VF_ABS(fx)), VF_ABS(fy));
+
+		// fold the lower hemisphere back out
+		vfloat t = VF_MAX(VF_SUB(VF_ZERO(), fz), VF_ZERO());
+		vfloat nt = VF_SUB(VF_ZERO(), t);
+		fx = VF_ADD(fx, VF_SELECT(VF_CMPGE(fx, VF_ZERO()), nt, t));
+		fy = VF_ADD(fy, VF_SELECT(VF_CMPGE(fy, VF_ZERO()), nt, t));
+
+		vfloat l = VF_FMADD(fz, fz, VF_FMADD(fy, fy, VF_MUL(fx, fx)));
+		vfloat invl = VF_DIV(one, VF_SQRT(l));
+
+		VF_STOREU(x + i, VF_MUL(fx, invl));
+		VF_STOREU(y + i, VF_MUL(fy, invl));
+		VF_STOREU(z + i, VF_MUL(fz, invl));
+	}
+
+	return i;
+}
+
+static int SIMD_FN(VertexStream_EncodeOctKernel)(unsigned short *u, unsigned short *v, const float *x, const float *y, const float *z, int start, int end)
+{
+	int i;
+	vfloat one = VF_SET1(1.0f);
+	vfloat minusone = VF_SET1(-1.0f);
+	vfloat snorm = VF_SET1(32767.0f);
+
+	for(i = start; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		vfloat fx = VF_LOADU(x + i);
+		vfloat fy = VF_LOADU(y + i);
+		vfloat fz = VF_LOADU(z + i);
+
+		// project onto the octahedron
+		vfloat invl1 = VF_DIV(one, VF_ADD(VF_ADD(VF_ABS(fx), VF_ABS(fy)), VF_ABS(fz)));
+		vfloat px = VF_MUL(fx, invl1);
+		vfloat py = VF_MUL(fy, invl1);
+
+		// fold the lower hemisphere over the diagonals
+		vfloat sx = VF_SELECT(VF_CMPGE(px, VF_ZERO()), one, minusone);
+		vfloat sy = VF_SELECT(VF_CMPGE(py, VF_ZERO()), one, minusone);
+		vfloat ox = VF_MUL(VF_SUB(one, VF_ABS(py)), sx);
+		vfloat oy = VF_MUL(VF_SUB(one, VF_ABS(px)), sy);
+		vmask lower = VF_CMPLT(fz, VF_ZERO());
+		px = VF_SELECT(lower, ox, px);
+		py = VF_SELECT(lower, oy, py);
+
+		px = VF_MIN(VF_MAX(px, minusone), one);
+		py = VF_MIN(VF_MAX(py, minusone), one);
+
+		SIMD_FN(VertexStream_StoreS16)(u + i, VF_MUL(px, snorm));
+		SIMD_FN(VertexStream_StoreS16)(v + i, VF_MUL(py, snorm));
+	}
+
+	return i;
+}
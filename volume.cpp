@@ -4,36 +4,40 @@
 
 int Volume_NumBytes(int maxsides)
 {
-	return sizeof(sizeof(volume_t) + maxsides * sizeof(volume_side_t));
+	return sizeof(volume_t) + maxsides * sizeof(volume_side_t);
 }
 
 volume_t *Volume_Alloc(int maxsides)
+{
+	return Volume_AllocWith(Allocator_Current(), maxsides);
+}
+
+volume_t *Volume_AllocWith(allocator_t *a, int maxsides)
 {
 	volume_t	*v;
 
 	int numbytes = Volume_NumBytes(maxsides);
-	v = (volume_t*)malloc(numbytes);
+	v = (volume_t*)Allocator_Alloc(a, numbytes);
 
 	v->maxsides	= maxsides;
 	v->numsides	= 0;
 	v->sides	= (volume_side_t*)(v + 1);
+	v->allocator	= a;
 
 	return v;
 }
 
 void Volume_Free(volume_t *v)
 {
-	free(v);
+	Allocator_Free(v->allocator, v);
 }
 
 volume_t *Volume_Copy(volume_t *v)
 {
 	volume_t	*c;
 
-	int numbytes = Volume_NumBytes(v->maxsides);
-	c = (volume_t*)malloc(numbytes);
-
-	memcpy(c, v, numbytes);
+	c = Volume_Alloc(v->maxsides);
+	c->numsides = v->numsides;
 
 	for(int i = 0; i < v->numsides; i++)
 	{
@@ -46,6 +50,7 @@ volume_t *Volume_Copy(volume_t *v)
 volume_t *Volume_Reverse(volume_t *v)
 {
 	volume_t* r = Volume_Alloc(v->maxsides);
+	r->numsides = v->numsides;
 
 	for(int i = 0; i < v->numsides; i++)
 	{
@@ -13,9 +13,12 @@ typedef struct volume_s
 	int	maxsides;
 	int	numsides;
 	volume_side_t	*sides;
+	allocator_t	*allocator;	// Volume_Free returns the memory here
 } volume_t;
 
+// new volumes come from Allocator_Current, as in allocator.h
 volume_t *Volume_Alloc(int maxsides);
+volume_t *Volume_AllocWith(allocator_t *a, int maxsides);
 void Volume_Free(volume_t *v);
 volume_t *Volume_Copy(volume_t *v);
 volume_t *Volume_Reverse(volume_t *v);